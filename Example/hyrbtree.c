@@ -19,6 +19,13 @@ enum{
     RBNODE_ADD_ROTATE_RR,
 };
 
+/* Search modes for single-descent bound queries */
+enum{
+    RBNODE_BOUND_LOWER,     ///< First node with key >= elem
+    RBNODE_BOUND_UPPER,     ///< First node with key > elem
+    RBNODE_BOUND_FLOOR,     ///< Last node with key <= elem
+};
+
 /* Rotation cases for deletion balancing */
 enum{
     RBNODE_DEL_LEFT_SILING,
@@ -33,6 +40,183 @@ enum{
 
 
 
+/**
+ * @brief Locate the embedded rbnode of a container
+ * @param tree Tree structure
+ * @param user_node Container structure
+ * @return Embedded rbnode
+ * 
+ * Uses get_rbnode when registered, otherwise rbnode_offset.
+ */
+static inline hyrbnode_t *hyrbtree_user_to_rbnode( hyrbtree_t *tree,void *user_node ){
+    if( tree->get_rbnode!=HY_NULL ){
+        return tree->get_rbnode(user_node);
+    }
+    return (hyrbnode_t *)((hy_u8_t *)user_node+tree->rbnode_offset);
+}
+
+/**
+ * @brief Locate the container of a linked rbnode
+ * @param tree Tree structure
+ * @param node Linked rbnode (never nil_node)
+ * @return Container structure
+ * 
+ * In offset mode the address is computed without loading user_node.
+ */
+static inline void *hyrbtree_rbnode_to_user( hyrbtree_t *tree,hyrbnode_t *node ){
+    if( tree->get_rbnode!=HY_NULL ){
+        return HYRBTREE_GET_NODE_ADDR(node);
+    }
+    return (void *)((hy_u8_t *)node-tree->rbnode_offset);
+}
+
+/**
+ * @brief Locate the key of a container
+ * @param tree Tree structure
+ * @param user_node Container structure
+ * @return Pointer to comparable key
+ * 
+ * Uses get_elem when registered, otherwise elem_offset.
+ */
+static inline void *hyrbtree_user_to_elem( hyrbtree_t *tree,void *user_node ){
+    if( tree->get_elem!=HY_NULL ){
+        return tree->get_elem(user_node);
+    }
+    return (void *)((hy_u8_t *)user_node+tree->elem_offset);
+}
+
+/**
+ * @brief Locate the key of a linked rbnode
+ * @param tree Tree structure
+ * @param node Linked rbnode (never nil_node)
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_rbnode_to_elem( hyrbtree_t *tree,hyrbnode_t *node ){
+    return hyrbtree_user_to_elem( tree,hyrbtree_rbnode_to_user(tree,node) );
+}
+
+/**
+ * @brief Get the container of an rbnode, HY_NULL for nil_node
+ * @param tree Tree structure
+ * @param node Linked rbnode or nil_node
+ * @return Container structure or HY_NULL
+ */
+static inline void *hyrbtree_rbnode_to_user_or_null( hyrbtree_t *tree,hyrbnode_t *node ){
+    if( node!=&tree->nil_node ){
+        return hyrbtree_rbnode_to_user(tree,node);
+    }
+    return HY_NULL;
+}
+
+
+
+/**
+ * @brief Project a key onto the key cache
+ * @param tree Tree structure
+ * @param elem Key element
+ * @return Cached prefix (0 when the cache is disabled)
+ */
+static inline hy_u64_t hyrbtree_elem_cache( hyrbtree_t *tree,void *elem ){
+#if HYRBTREE_CFG_KEY_CACHE
+    if( tree->get_elem_cache!=HY_NULL ){
+        return tree->get_elem_cache(elem);
+    }
+#endif
+    (void)tree;
+    (void)elem;
+    return 0;
+}
+
+/**
+ * @brief Compare a key against a linked rbnode
+ * @param tree Tree structure
+ * @param elem Key element
+ * @param elem_cache Cached prefix of elem (from hyrbtree_elem_cache)
+ * @param node Linked rbnode (never nil_node)
+ * @return <0 if elem sorts before node, 0 if equal, >0 otherwise
+ * 
+ * With the key cache enabled the container is only touched on prefix ties.
+ */
+static inline hy_i32_t hyrbtree_cmp_rbnode( hyrbtree_t *tree,void *elem,hy_u64_t elem_cache,hyrbnode_t *node ){
+#if HYRBTREE_CFG_KEY_CACHE
+    if( tree->get_elem_cache!=HY_NULL ){
+        if( elem_cache<node->elem_cache ){
+            return -1;
+        }
+        if( elem_cache>node->elem_cache ){
+            return 1;
+        }
+    }
+#endif
+    (void)elem_cache;
+    return tree->cmp_elem( elem,hyrbtree_rbnode_to_elem(tree,node) );
+}
+
+
+
+/**
+ * @brief Recompute the aggregate of one linked rbnode from its children
+ * @param tree Tree structure (augment_node registered)
+ * @param node Linked rbnode (never nil_node)
+ * @return Result of augment_node
+ */
+static inline hy_u8_t hyrbtree_augment_rbnode( hyrbtree_t *tree,hyrbnode_t *node ){
+    return tree->augment_node( hyrbtree_rbnode_to_user(tree,node),
+        hyrbtree_rbnode_to_user_or_null(tree,node->left_node),
+        hyrbtree_rbnode_to_user_or_null(tree,node->right_node) );
+}
+
+/**
+ * @brief Recompute aggregates from node up to the root
+ * @param tree Tree structure
+ * @param node Lowest rbnode whose subtree changed (nil_node is a no-op)
+ * @param stop_unchanged Stop at the first ancestor whose aggregate did not change
+ *
+ * node itself is always refreshed, since a freshly linked container may
+ * hold a stale aggregate that happens to match. No-op when augment_node
+ * is not registered.
+ */
+static void hyrbtree_augment_path( hyrbtree_t *tree,hyrbnode_t *node,hy_u8_t stop_unchanged ){
+    if( tree->augment_node!=HY_NULL && node!=&tree->nil_node ){
+        hyrbtree_augment_rbnode(tree,node);
+        for( node=node->parent_node;node!=&tree->nil_node;node=node->parent_node ){
+            if( hyrbtree_augment_rbnode(tree,node)==0 && stop_unchanged ){
+                break;
+            }
+        }
+    }
+}
+
+
+
+#if HYRBTREE_CFG_KEY_CACHE
+/**
+ * @brief Key cache projection for NUL-terminated strings
+ * @param str String key
+ * @return First 8 bytes packed big-endian, zero padded
+ * 
+ * Preserves strcmp ordering, suitable as get_elem_cache for string keys.
+ */
+hy_u64_t hyrbtree_elem_cache_str( const void *str ){
+    const hy_u8_t *str_ptr;
+    hy_u64_t elem_cache;
+    hy_u8_t i;
+
+    str_ptr = (const hy_u8_t *)str;
+    elem_cache = 0;
+    for( i=0;i<8;i++ ){
+        elem_cache = elem_cache<<8;
+        if( *str_ptr!=0 ){
+            elem_cache = elem_cache|*str_ptr;
+            str_ptr++;
+        }
+    }
+    return elem_cache;
+}
+#endif
+
+
+
 /**
  * @brief Initialize a Red-Black Tree
  * @param tree Pointer to the tree structure
@@ -41,18 +225,25 @@ enum{
  */
 void hyrbtree_init( hyrbtree_t *tree ){
     tree->root_node = &tree->nil_node;
+    tree->first_node = &tree->nil_node;
+    tree->last_node = &tree->nil_node;
+    tree->node_count = 0;
     tree->nil_node.user_node = (void *)((hy_uptr_t)(tree->nil_node.user_node) | (hy_uptr_t)(0x1));
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    tree->nil_node.subtree_size = 0;
+#endif
 }
 
 
 
 /**
  * @brief Perform left rotation
+ * @param tree Tree structure
  * @param node Pivot node for rotation
  * 
  * Used during tree rebalancing. Modifies tree topology while preserving BST properties.
  */
-static void hyrbtree_left_rotate_node( hyrbnode_t *node ){
+static void hyrbtree_left_rotate_node( hyrbtree_t *tree,hyrbnode_t *node ){
     hyrbnode_t *center_node;
 
     center_node = node->right_node;
@@ -69,15 +260,24 @@ static void hyrbtree_left_rotate_node( hyrbnode_t *node ){
 
     center_node->left_node = node;
     node->right_node->parent_node = node;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    center_node->subtree_size = node->subtree_size;
+    node->subtree_size = node->left_node->subtree_size+node->right_node->subtree_size+1;
+#endif
+    if( tree->augment_node!=HY_NULL ){
+        hyrbtree_augment_rbnode(tree,node);
+        hyrbtree_augment_rbnode(tree,center_node);
+    }
 }
 
 /**
  * @brief Perform right rotation
+ * @param tree Tree structure
  * @param node Pivot node for rotation
  * 
  * Mirror operation of left_rotate_node.
  */
-static void hyrbtree_right_rotate_node( hyrbnode_t *node ){
+static void hyrbtree_right_rotate_node( hyrbtree_t *tree,hyrbnode_t *node ){
     hyrbnode_t *center_node;
 
     center_node = node->left_node;
@@ -94,6 +294,14 @@ static void hyrbtree_right_rotate_node( hyrbnode_t *node ){
 
     center_node->right_node = node;
     node->left_node->parent_node = node;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    center_node->subtree_size = node->subtree_size;
+    node->subtree_size = node->left_node->subtree_size+node->right_node->subtree_size+1;
+#endif
+    if( tree->augment_node!=HY_NULL ){
+        hyrbtree_augment_rbnode(tree,node);
+        hyrbtree_augment_rbnode(tree,center_node);
+    }
 }
 
 
@@ -152,21 +360,21 @@ void hyrbtree_add_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
             switch( balance_case ){
                 case RBNODE_ADD_ROTATE_LL:
                     HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                    hyrbtree_right_rotate_node(grandpa_rbnode);
+                    hyrbtree_right_rotate_node(rbtree,grandpa_rbnode);
                     break;
                 case RBNODE_ADD_ROTATE_RL:
                     HYRBTREE_SET_NODE_BLACK(cur_node);
-                    hyrbtree_right_rotate_node(parent_rbnode);
-                    hyrbtree_left_rotate_node(grandpa_rbnode);
+                    hyrbtree_right_rotate_node(rbtree,parent_rbnode);
+                    hyrbtree_left_rotate_node(rbtree,grandpa_rbnode);
                     break;
                 case RBNODE_ADD_ROTATE_LR:
                     HYRBTREE_SET_NODE_BLACK(cur_node);
-                    hyrbtree_left_rotate_node(parent_rbnode);
-                    hyrbtree_right_rotate_node(grandpa_rbnode);
+                    hyrbtree_left_rotate_node(rbtree,parent_rbnode);
+                    hyrbtree_right_rotate_node(rbtree,grandpa_rbnode);
                     break;
                 case RBNODE_ADD_ROTATE_RR:
                     HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                    hyrbtree_left_rotate_node(grandpa_rbnode);
+                    hyrbtree_left_rotate_node(rbtree,grandpa_rbnode);
                     break;
                 default:
                     break;
@@ -188,6 +396,66 @@ void hyrbtree_add_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
     }
 }
 
+/**
+ * @brief Link a detached node at a leaf position and rebalance
+ * @param tree Tree structure
+ * @param add_node Embedded rbnode of the new node
+ * @param user_node Container structure of add_node
+ * @param parent_node Last node visited by the descent (ignored on empty tree)
+ * @param result Comparison result that ended the descent (<0 left, >0 right)
+ * 
+ * Shared tail of every insertion path, including specialized trees.
+ */
+void hyrbtree_link_node( hyrbtree_t *tree,hyrbnode_t *add_node,void *user_node,
+    hyrbnode_t *parent_node,hy_i32_t result ){
+
+    add_node->left_node = &tree->nil_node;
+    add_node->right_node = &tree->nil_node;
+    add_node->user_node = user_node;
+#if HYRBTREE_CFG_KEY_CACHE
+    add_node->elem_cache = hyrbtree_elem_cache( tree,hyrbtree_user_to_elem(tree,user_node) );
+#endif
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    add_node->subtree_size = 1;
+#endif
+    tree->node_count++;
+
+    if( tree->root_node!=&tree->nil_node ){
+        if( result<0 ){
+            parent_node->left_node = add_node;
+            if( parent_node==tree->first_node ){
+                tree->first_node = add_node;
+            }
+        }
+        else{
+            parent_node->right_node = add_node;
+            if( parent_node==tree->last_node ){
+                tree->last_node = add_node;
+            }
+        }
+        add_node->parent_node = parent_node;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+        for( ;parent_node!=&tree->nil_node;parent_node=parent_node->parent_node ){
+            parent_node->subtree_size++;
+        }
+#endif
+        hyrbtree_augment_path(tree,add_node,1);
+
+        if( HYRBTREE_READ_NODE_COLOR(add_node->parent_node)==HYRBTREE_NODE_RED ){
+            hyrbtree_add_balance(tree,add_node);
+        }
+    }
+    else{
+        tree->root_node = add_node;
+        tree->first_node = add_node;
+        tree->last_node = add_node;
+        HYRBTREE_SET_NODE_BLACK(tree->root_node);
+        tree->root_node->parent_node = &tree->nil_node;
+        tree->nil_node.left_node = tree->root_node;
+        hyrbtree_augment_path(tree,add_node,1);
+    }
+}
+
 /**
  * @brief Insert a node into the tree
  * @param tree Tree structure
@@ -195,7 +463,9 @@ void hyrbtree_add_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
  * @param exist_node [out] Returns existing node if key exists
  * @return Operation status code
  * 
- * Performs standard BST insertion followed by rebalancing.
+ * Performs standard BST insertion followed by rebalancing. In multimap
+ * mode an equal key is linked after the nodes already holding it, so
+ * duplicates keep insertion order and no collision is reported.
  * Returns:
  * - HYRBTREE_RET_OK: Success
  * - HYRBTREE_RET_ADD_NODE_ELEM_EXIST: Key collision
@@ -207,63 +477,106 @@ hyrbtree_ret_t hyrbtree_add_node( hyrbtree_t *tree,void *user_node,void **exist_
     hyrbnode_t *parent_node;
     hy_i32_t result;
     void *add_node_elem;
-    void *cur_node_elem;
+    hy_u64_t add_node_cache;
 
-    add_node = tree->get_rbnode(user_node);
+    add_node = hyrbtree_user_to_rbnode(tree,user_node);
     if( HYRBTREE_GET_NODE_ADDR(add_node)==HY_NULL ){
 
-        add_node->left_node = &tree->nil_node;
-        add_node->right_node = &tree->nil_node;
+        parent_node = &tree->nil_node;
+        result = 0;
 
         if( tree->root_node!=&tree->nil_node ){
 
-            add_node_elem = tree->get_elem(user_node);
+            add_node_elem = hyrbtree_user_to_elem(tree,user_node);
+            add_node_cache = hyrbtree_elem_cache(tree,add_node_elem);
             cur_node = tree->root_node;
             
             while(1){
-                cur_node_elem = tree->get_elem(HYRBTREE_GET_NODE_ADDR(cur_node));
                 parent_node = cur_node;
 
-                result = tree->cmp_elem(add_node_elem,cur_node_elem);
+                result = hyrbtree_cmp_rbnode(tree,add_node_elem,add_node_cache,cur_node);
                 if( result<0 ){
                     cur_node = cur_node->left_node;
                     if( cur_node==&tree->nil_node ){
-                        parent_node->left_node = add_node;
-                        add_node->parent_node = parent_node;
                         break;
                     }
                 }
-                else if( result>0 ){
+                else if( result>0 || tree->multi_elem!=0 ){
                     cur_node = cur_node->right_node;
                     if( cur_node==&tree->nil_node ){
-                        parent_node->right_node = add_node;
-                        add_node->parent_node = parent_node;
                         break;
                     }
                 }
                 else{
-                    *exist_node = HYRBTREE_GET_NODE_ADDR(cur_node);
+                    *exist_node = hyrbtree_rbnode_to_user(tree,cur_node);
                     return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
                 }
             }
+        }
+
+        hyrbtree_link_node( tree,add_node,user_node,parent_node,result );
+        return HYRBTREE_RET_OK;
+    }
+    return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+}
+
+/**
+ * @brief Return the node holding a key, inserting user_node if there is none
+ * @param tree Tree structure
+ * @param user_node User data containing embedded rbnode, key set
+ * @param get_node [out] Node holding the key afterwards (user_node if inserted)
+ * @param inserted [out] Non-zero if user_node was linked
+ * @return Operation status code
+ * 
+ * Upsert in one descent: the walk that misses the key also yields the leaf
+ * position, so no second search is made. In multimap mode an existing key
+ * returns its first duplicate instead of adding another.
+ * Returns:
+ * - HYRBTREE_RET_OK: get_node holds the key
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: Invalid node
+ */
+hyrbtree_ret_t hyrbtree_find_or_add( hyrbtree_t *tree,void *user_node,void **get_node,hy_u8_t *inserted ){
+    hyrbnode_t *add_node;
+    hyrbnode_t *cur_node;
+    hyrbnode_t *parent_node;
+    hyrbnode_t *found_node;
+    hy_i32_t result;
+    void *add_node_elem;
+    hy_u64_t add_node_cache;
 
-            add_node->user_node = user_node;
+    add_node = hyrbtree_user_to_rbnode(tree,user_node);
+    if( HYRBTREE_GET_NODE_ADDR(add_node)!=HY_NULL ){
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    }
 
-            if( HYRBTREE_READ_NODE_COLOR(add_node->parent_node)==HYRBTREE_NODE_RED ){
-                hyrbtree_add_balance(tree,add_node);
+    add_node_elem = hyrbtree_user_to_elem(tree,user_node);
+    add_node_cache = hyrbtree_elem_cache(tree,add_node_elem);
+    parent_node = &tree->nil_node;
+    found_node = &tree->nil_node;
+    result = 0;
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        parent_node = cur_node;
+        result = hyrbtree_cmp_rbnode(tree,add_node_elem,add_node_cache,cur_node);
+        if( result==0 ){
+            found_node = cur_node;
+            if( tree->multi_elem==0 ){
+                break;
             }
+            result = -1;
         }
-        else{
-            add_node->user_node = user_node;
-            
-            tree->root_node = add_node;
-            HYRBTREE_SET_NODE_BLACK(tree->root_node);
-            tree->root_node->parent_node = &tree->nil_node;
-            tree->nil_node.left_node = tree->root_node;
-        }
+        cur_node = (result<0) ? cur_node->left_node : cur_node->right_node;
+    }
+
+    if( found_node!=&tree->nil_node ){
+        *get_node = hyrbtree_rbnode_to_user(tree,found_node);
+        *inserted = 0;
         return HYRBTREE_RET_OK;
     }
-    return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    hyrbtree_link_node( tree,add_node,user_node,parent_node,result );
+    *get_node = user_node;
+    *inserted = 1;
+    return HYRBTREE_RET_OK;
 }
 
 
@@ -277,6 +590,9 @@ hyrbtree_ret_t hyrbtree_add_node( hyrbtree_t *tree,void *user_node,void **exist_
  */
 void hyrbtree_replace_successor( hyrbtree_t *tree,hyrbnode_t *node ){
     hyrbnode_t *cur_node;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    hy_u32_t subtree_size;
+#endif
 
     if( node->right_node!=&tree->nil_node ){
 
@@ -298,6 +614,12 @@ void hyrbtree_replace_successor( hyrbtree_t *tree,hyrbnode_t *node ){
             }
         }
 
+#if HYRBTREE_CFG_SUBTREE_SIZE
+        subtree_size = cur_node->subtree_size;
+        cur_node->subtree_size = node->subtree_size;
+        node->subtree_size = subtree_size;
+#endif
+
         cur_node->left_node = node->left_node;
         node->left_node->parent_node = cur_node;
         node->left_node = &tree->nil_node;
@@ -356,6 +678,10 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
         }
         cur_node->right_node->parent_node = cur_node->parent_node;
         HYRBTREE_SET_NODE_BLACK(cur_node->right_node);
+        if( cur_node==rbtree->root_node ){
+            rbtree->root_node = cur_node->right_node;
+            rbtree->nil_node.left_node = rbtree->root_node;
+        }
     }
     else if( cur_node->left_node!=&rbtree->nil_node ){
         if( cur_node->parent_node->left_node==cur_node ){
@@ -439,8 +765,8 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
                             HYRBTREE_SET_NODE_BLACK(sibling_rbnode->right_node);
                         }
                         HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                        hyrbtree_left_rotate_node(sibling_rbnode);
-                        hyrbtree_right_rotate_node(parent_rbnode);
+                        hyrbtree_left_rotate_node(rbtree,sibling_rbnode);
+                        hyrbtree_right_rotate_node(rbtree,parent_rbnode);
                         break;
 
                     case RBNODE_DEL_ROTATE_LL_0:
@@ -453,7 +779,7 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
                             HYRBTREE_SET_NODE_BLACK(sibling_rbnode);
                         }
                         HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                        hyrbtree_right_rotate_node(parent_rbnode);
+                        hyrbtree_right_rotate_node(rbtree,parent_rbnode);
                         break;
 
                     case RBNODE_DEL_ROTATE_RL:
@@ -464,8 +790,8 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
                             HYRBTREE_SET_NODE_BLACK(sibling_rbnode->left_node);
                         }
                         HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                        hyrbtree_right_rotate_node(sibling_rbnode);
-                        hyrbtree_left_rotate_node(parent_rbnode);
+                        hyrbtree_right_rotate_node(rbtree,sibling_rbnode);
+                        hyrbtree_left_rotate_node(rbtree,parent_rbnode);
                         break;
 
                     case RBNODE_DEL_ROTATE_RR_0:
@@ -478,7 +804,7 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
                             HYRBTREE_SET_NODE_BLACK(sibling_rbnode);
                         }
                         HYRBTREE_SET_NODE_BLACK(parent_rbnode);
-                        hyrbtree_left_rotate_node(parent_rbnode);
+                        hyrbtree_left_rotate_node(rbtree,parent_rbnode);
                         break;
                     
                     default:
@@ -502,10 +828,10 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
                 HYRBTREE_SET_NODE_RED(parent_rbnode);
                 switch( balance_case ){
                     case RBNODE_DEL_LEFT_SILING:
-                        hyrbtree_right_rotate_node(parent_rbnode);
+                        hyrbtree_right_rotate_node(rbtree,parent_rbnode);
                         break;
                     case RBNODE_DEL_RIGHT_SILING:
-                        hyrbtree_left_rotate_node(parent_rbnode);
+                        hyrbtree_left_rotate_node(rbtree,parent_rbnode);
                         break;
                     default:
                         break;
@@ -522,6 +848,40 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
     }
 }
 
+/**
+ * @brief Detach a linked node and rebalance
+ * @param tree Tree structure
+ * @param node Embedded rbnode currently linked in tree
+ * 
+ * Shared tail of every deletion path, including specialized trees.
+ * The node is left uninitialized (user_node cleared) for reuse.
+ */
+void hyrbtree_unlink_node( hyrbtree_t *tree,hyrbnode_t *node ){
+    hyrbnode_t *parent_node;
+
+    /* An extreme node's only possible child is a red leaf on the inner side */
+    if( node==tree->first_node ){
+        tree->first_node = (node->right_node!=&tree->nil_node) ? node->right_node : node->parent_node;
+    }
+    if( node==tree->last_node ){
+        tree->last_node = (node->left_node!=&tree->nil_node) ? node->left_node : node->parent_node;
+    }
+    /* With at most one child the node is spliced out in place, no successor swap */
+    if( node->left_node!=&tree->nil_node ){
+        hyrbtree_replace_successor( tree,node );
+    }
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    for( parent_node=node->parent_node;parent_node!=&tree->nil_node;parent_node=parent_node->parent_node ){
+        parent_node->subtree_size--;
+    }
+#endif
+    parent_node = node->parent_node;
+    hyrbtree_del_balance( tree,node );
+    hyrbtree_augment_path(tree,parent_node,0);
+    node->user_node = HY_NULL;
+    tree->node_count--;
+}
+
 /**
  * @brief Remove a node from the tree
  * @param tree Tree structure
@@ -535,16 +895,61 @@ void hyrbtree_del_balance( hyrbtree_t *rbtree , hyrbnode_t *cur_node ){
 hyrbtree_ret_t hyrbtree_del_node( hyrbtree_t *tree,void *user_node ){
     hyrbnode_t *node;
 
-    node = tree->get_rbnode(user_node);
+    node = hyrbtree_user_to_rbnode(tree,user_node);
     if( HYRBTREE_GET_NODE_ADDR(node)==user_node ){
-        hyrbtree_replace_successor( tree,node );
-        hyrbtree_del_balance( tree,node );
-        node->user_node = HY_NULL;
+        hyrbtree_unlink_node( tree,node );
         return HYRBTREE_RET_OK;
     }
     return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
 }
 
+/**
+ * @brief Remove the node holding a key
+ * @param tree Tree structure
+ * @param elem Key to remove
+ * @param del_node [out] Removed node, ready to be freed or reused
+ * @return Operation status code
+ * 
+ * Unlinks the node reached by the search descent directly, without a
+ * separate lookup. In multimap mode the first duplicate is removed.
+ * Returns:
+ * - HYRBTREE_RET_OK: Removed
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Not found
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_del_by_elem( hyrbtree_t *tree,void *elem,void **del_node ){
+    hyrbnode_t *cur_node;
+    hyrbnode_t *found_node;
+    hy_u64_t elem_cache;
+    hy_i32_t result;
+
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    elem_cache = hyrbtree_elem_cache(tree,elem);
+    found_node = &tree->nil_node;
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,cur_node);
+        if( result==0 ){
+            found_node = cur_node;
+            if( tree->multi_elem==0 ){
+                break;
+            }
+            result = -1;
+        }
+        cur_node = (result<0) ? cur_node->left_node : cur_node->right_node;
+    }
+
+    if( found_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+    *del_node = hyrbtree_rbnode_to_user(tree,found_node);
+    hyrbtree_unlink_node( tree,found_node );
+    return HYRBTREE_RET_OK;
+}
+
 
 
 /**
@@ -554,6 +959,7 @@ hyrbtree_ret_t hyrbtree_del_node( hyrbtree_t *tree,void *user_node ){
  * @param get_node [out] Found node
  * @return Operation status code
  * 
+ * In multimap mode the first node holding the key is returned.
  * Returns:
  * - HYRBTREE_RET_OK: Found
  * - HYRBTREE_RET_GET_NODE_NOT_FIND: Not found
@@ -561,14 +967,17 @@ hyrbtree_ret_t hyrbtree_del_node( hyrbtree_t *tree,void *user_node ){
  */
 hyrbtree_ret_t hyrbtree_get_node( hyrbtree_t *tree,void *get_node_elem,void **get_node ){
     hyrbnode_t *cur_node;
-    void *cur_node_elem;
+    hy_u64_t get_node_cache;
     hy_i32_t result;
 
     if( tree->root_node!=&tree->nil_node ){
+        if( tree->multi_elem!=0 ){
+            return hyrbtree_equal_range( tree,get_node_elem,get_node,HY_NULL );
+        }
+        get_node_cache = hyrbtree_elem_cache(tree,get_node_elem);
         cur_node = tree->root_node;
         while(1){
-            cur_node_elem = tree->get_elem(HYRBTREE_GET_NODE_ADDR(cur_node));
-            result = tree->cmp_elem(get_node_elem,cur_node_elem);
+            result = hyrbtree_cmp_rbnode(tree,get_node_elem,get_node_cache,cur_node);
             if( result<0 ){
                 cur_node = cur_node->left_node;
                 if( cur_node==&tree->nil_node ){
@@ -582,7 +991,7 @@ hyrbtree_ret_t hyrbtree_get_node( hyrbtree_t *tree,void *get_node_elem,void **ge
                 }
             }
             else{
-                *get_node = HYRBTREE_GET_NODE_ADDR(cur_node);
+                *get_node = hyrbtree_rbnode_to_user(tree,cur_node);
                 return HYRBTREE_RET_OK;
             }
         }
@@ -592,6 +1001,113 @@ hyrbtree_ret_t hyrbtree_get_node( hyrbtree_t *tree,void *get_node_elem,void **ge
 
 
 
+/**
+ * @brief Prefetch an rbnode and the key the next comparison will read
+ * @param tree Tree structure
+ * @param node Linked rbnode
+ * 
+ * The key address is only computable without a load in offset mode and is
+ * not needed when the key cache decides the direction.
+ */
+static inline void hyrbtree_prefetch_rbnode( hyrbtree_t *tree,hyrbnode_t *node ){
+    HY_PREFETCH(node);
+#if HYRBTREE_CFG_KEY_CACHE
+    if( tree->get_elem_cache!=HY_NULL ){
+        return;
+    }
+#endif
+    if( tree->get_rbnode==HY_NULL && tree->get_elem==HY_NULL ){
+        HY_PREFETCH( (hy_u8_t *)node-tree->rbnode_offset+tree->elem_offset );
+    }
+}
+
+/**
+ * @brief Search for many keys with interleaved descents
+ * @param tree Tree structure
+ * @param elems Keys to search for
+ * @param elem_num Key count
+ * @param get_nodes [out] Per key: found node, HY_NULL if absent
+ * @return Operation status code
+ * 
+ * Up to HYRBTREE_CFG_GET_LANES independent descents advance one level per
+ * round. Each lane prefetches its next node before the other lanes run, so
+ * the cache misses of different lookups overlap instead of serializing.
+ * In multimap mode a lane continues left past an equal node, so each key
+ * yields its first node as in hyrbtree_get_node.
+ * Returns:
+ * - HYRBTREE_RET_OK: All keys processed
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree (get_nodes untouched)
+ */
+hyrbtree_ret_t hyrbtree_get_nodes( hyrbtree_t *tree,void **elems,hy_u32_t elem_num,void **get_nodes ){
+    hyrbnode_t *lane_node[HYRBTREE_CFG_GET_LANES];
+    hy_u64_t lane_cache[HYRBTREE_CFG_GET_LANES];
+    hy_u32_t lane_pos[HYRBTREE_CFG_GET_LANES];
+    hy_u32_t lane_num;
+    hy_u32_t read_pos;
+    hy_u32_t i;
+    hyrbnode_t *cur_node;
+    hy_i32_t result;
+
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    lane_num = 0;
+    for( read_pos=0;read_pos<elem_num && lane_num<HYRBTREE_CFG_GET_LANES;read_pos++ ){
+        lane_node[lane_num] = tree->root_node;
+        lane_cache[lane_num] = hyrbtree_elem_cache(tree,elems[read_pos]);
+        lane_pos[lane_num] = read_pos;
+        get_nodes[read_pos] = HY_NULL;
+        lane_num++;
+    }
+
+    while( lane_num>0 ){
+        i = 0;
+        while( i<lane_num ){
+            cur_node = lane_node[i];
+            result = hyrbtree_cmp_rbnode(tree,elems[lane_pos[i]],lane_cache[i],cur_node);
+            if( result==0 ){
+                get_nodes[lane_pos[i]] = hyrbtree_rbnode_to_user(tree,cur_node);
+                if( tree->multi_elem!=0 ){
+                    result = -1;
+                }
+            }
+            if( result<0 ){
+                cur_node = cur_node->left_node;
+            }
+            else if( result>0 ){
+                cur_node = cur_node->right_node;
+            }
+
+            if( result!=0 && cur_node!=&tree->nil_node ){
+                hyrbtree_prefetch_rbnode( tree,cur_node );
+                lane_node[i] = cur_node;
+                i++;
+                continue;
+            }
+
+            /* Lane finished (result already published): refill or retire it */
+            if( read_pos<elem_num ){
+                lane_node[i] = tree->root_node;
+                lane_cache[i] = hyrbtree_elem_cache(tree,elems[read_pos]);
+                lane_pos[i] = read_pos;
+                get_nodes[read_pos] = HY_NULL;
+                read_pos++;
+                i++;
+            }
+            else{
+                lane_num--;
+                lane_node[i] = lane_node[lane_num];
+                lane_cache[i] = lane_cache[lane_num];
+                lane_pos[i] = lane_pos[lane_num];
+            }
+        }
+    }
+    return HYRBTREE_RET_OK;
+}
+
+
+
 /**
  * @brief Replace a node while preserving tree structure
  * @param tree Tree structure
@@ -612,18 +1128,21 @@ hyrbtree_ret_t hyrbtree_replace_node( hyrbtree_t *tree,void *old_node,void *new_
     void *new_elem;
     hy_i32_t result;
 
-    old_rbnode = tree->get_rbnode(old_node);
-    new_rbnode = tree->get_rbnode(new_node);
+    old_rbnode = hyrbtree_user_to_rbnode(tree,old_node);
+    new_rbnode = hyrbtree_user_to_rbnode(tree,new_node);
 
     if( HYRBTREE_GET_NODE_ADDR(old_rbnode)==old_node && 
         HYRBTREE_GET_NODE_ADDR(new_rbnode)==HY_NULL ){
 
-        old_elem = tree->get_elem(old_node);
-        new_elem = tree->get_elem(new_node);
+        old_elem = hyrbtree_user_to_elem(tree,old_node);
+        new_elem = hyrbtree_user_to_elem(tree,new_node);
 
         result = tree->cmp_elem(old_elem,new_elem);
         if( result==0 ){
             new_rbnode->user_node = new_node;
+#if HYRBTREE_CFG_KEY_CACHE
+            new_rbnode->elem_cache = hyrbtree_elem_cache(tree,new_elem);
+#endif
             if( HYRBTREE_READ_NODE_COLOR(old_rbnode)==HYRBTREE_NODE_RED ){
                 HYRBTREE_SET_NODE_RED(new_rbnode);
             }
@@ -635,6 +1154,9 @@ hyrbtree_ret_t hyrbtree_replace_node( hyrbtree_t *tree,void *old_node,void *new_
             new_rbnode->parent_node = old_rbnode->parent_node;
             new_rbnode->left_node = old_rbnode->left_node;
             new_rbnode->right_node = old_rbnode->right_node;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+            new_rbnode->subtree_size = old_rbnode->subtree_size;
+#endif
 
             if( old_rbnode->parent_node->left_node==old_rbnode ){
                 old_rbnode->parent_node->left_node = new_rbnode;
@@ -645,9 +1167,1239 @@ hyrbtree_ret_t hyrbtree_replace_node( hyrbtree_t *tree,void *old_node,void *new_
             old_rbnode->left_node->parent_node = new_rbnode;
             old_rbnode->right_node->parent_node = new_rbnode;
 
+            if( old_rbnode==tree->root_node ){
+                tree->root_node = new_rbnode;
+            }
+            if( old_rbnode==tree->first_node ){
+                tree->first_node = new_rbnode;
+            }
+            if( old_rbnode==tree->last_node ){
+                tree->last_node = new_rbnode;
+            }
+            hyrbtree_augment_path(tree,new_rbnode,1);
+
             return HYRBTREE_RET_OK;
         }
         return HYRBTREE_RET_REPLACE_CMP_ERROR;
     }
     return HYRBTREE_RET_REPLACE_INIT_ERROR;
 }
+
+
+
+/**
+ * @brief Get the in-order successor of a linked rbnode
+ * @param tree Tree structure
+ * @param node Linked rbnode
+ * @return Successor rbnode, nil_node if node is the last one
+ * 
+ * Amortized O(1) over a full scan: every link is crossed at most twice.
+ */
+static hyrbnode_t *hyrbtree_next_rbnode( hyrbtree_t *tree,hyrbnode_t *node ){
+    hyrbnode_t *parent_node;
+
+    if( node->right_node!=&tree->nil_node ){
+        node = node->right_node;
+        while( node->left_node!=&tree->nil_node ){
+            node = node->left_node;
+        }
+        return node;
+    }
+
+    parent_node = node->parent_node;
+    while( parent_node!=&tree->nil_node && node==parent_node->right_node ){
+        node = parent_node;
+        parent_node = node->parent_node;
+    }
+    return parent_node;
+}
+
+/**
+ * @brief Get the in-order predecessor of a linked rbnode
+ * @param tree Tree structure
+ * @param node Linked rbnode
+ * @return Predecessor rbnode, nil_node if node is the first one
+ * 
+ * Mirror operation of hyrbtree_next_rbnode.
+ */
+static hyrbnode_t *hyrbtree_prev_rbnode( hyrbtree_t *tree,hyrbnode_t *node ){
+    hyrbnode_t *parent_node;
+
+    if( node->left_node!=&tree->nil_node ){
+        node = node->left_node;
+        while( node->right_node!=&tree->nil_node ){
+            node = node->right_node;
+        }
+        return node;
+    }
+
+    parent_node = node->parent_node;
+    while( parent_node!=&tree->nil_node && node==parent_node->left_node ){
+        node = parent_node;
+        parent_node = node->parent_node;
+    }
+    return parent_node;
+}
+
+/**
+ * @brief Get the node with the smallest key
+ * @param tree Tree structure
+ * @return First container in order, HY_NULL if the tree is empty
+ * 
+ * O(1): the leftmost node is kept up to date by every link and unlink.
+ */
+void *hyrbtree_first( hyrbtree_t *tree ){
+    return hyrbtree_rbnode_to_user_or_null( tree,tree->first_node );
+}
+
+/**
+ * @brief Get the node with the largest key
+ * @param tree Tree structure
+ * @return Last container in order, HY_NULL if the tree is empty
+ * 
+ * O(1), see hyrbtree_first.
+ */
+void *hyrbtree_last( hyrbtree_t *tree ){
+    return hyrbtree_rbnode_to_user_or_null( tree,tree->last_node );
+}
+
+/**
+ * @brief Step to the next node in key order
+ * @param tree Tree structure
+ * @param user_node Container currently linked in tree
+ * @return Next container, HY_NULL at the end
+ * 
+ * Uses parent links only: no recursion and no allocation.
+ */
+void *hyrbtree_next( hyrbtree_t *tree,void *user_node ){
+    hyrbnode_t *node;
+
+    node = hyrbtree_user_to_rbnode(tree,user_node);
+    return hyrbtree_rbnode_to_user_or_null( tree,hyrbtree_next_rbnode(tree,node) );
+}
+
+/**
+ * @brief Step to the previous node in key order
+ * @param tree Tree structure
+ * @param user_node Container currently linked in tree
+ * @return Previous container, HY_NULL at the beginning
+ */
+void *hyrbtree_prev( hyrbtree_t *tree,void *user_node ){
+    hyrbnode_t *node;
+
+    node = hyrbtree_user_to_rbnode(tree,user_node);
+    return hyrbtree_rbnode_to_user_or_null( tree,hyrbtree_prev_rbnode(tree,node) );
+}
+
+/**
+ * @brief Remove the node with the smallest key
+ * @param tree Tree structure
+ * @param pop_node [out] Removed node, ready to be freed or reused
+ * @return Operation status code
+ * 
+ * Priority-queue pop without comparisons or descent. The leftmost node has
+ * at most one child, so it is spliced out in place with no successor swap.
+ * Returns:
+ * - HYRBTREE_RET_OK: Removed
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_pop_first( hyrbtree_t *tree,void **pop_node ){
+    hyrbnode_t *node;
+
+    node = tree->first_node;
+    if( node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    *pop_node = hyrbtree_rbnode_to_user(tree,node);
+    hyrbtree_unlink_node( tree,node );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Remove the node with the largest key
+ * @param tree Tree structure
+ * @param pop_node [out] Removed node, ready to be freed or reused
+ * @return Operation status code (see hyrbtree_pop_first)
+ */
+hyrbtree_ret_t hyrbtree_pop_last( hyrbtree_t *tree,void **pop_node ){
+    hyrbnode_t *node;
+
+    node = tree->last_node;
+    if( node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    *pop_node = hyrbtree_rbnode_to_user(tree,node);
+    hyrbtree_unlink_node( tree,node );
+    return HYRBTREE_RET_OK;
+}
+
+
+
+/**
+ * @brief Single-descent bound search
+ * @param tree Tree structure (not empty)
+ * @param elem Key to search for
+ * @param bound_mode One of RBNODE_BOUND_*
+ * @return Matching rbnode, nil_node if none
+ */
+static hyrbnode_t *hyrbtree_bound_rbnode( hyrbtree_t *tree,void *elem,hy_u8_t bound_mode ){
+    hyrbnode_t *cur_node;
+    hyrbnode_t *bound_node;
+    hy_u64_t elem_cache;
+    hy_i32_t result;
+
+    elem_cache = hyrbtree_elem_cache(tree,elem);
+    bound_node = &tree->nil_node;
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,cur_node);
+        if( bound_mode==RBNODE_BOUND_FLOOR ){
+            if( result>=0 ){
+                bound_node = cur_node;
+                cur_node = cur_node->right_node;
+            }
+            else{
+                cur_node = cur_node->left_node;
+            }
+        }
+        else{
+            if( result<0 || (result==0 && bound_mode==RBNODE_BOUND_LOWER) ){
+                bound_node = cur_node;
+                cur_node = cur_node->left_node;
+            }
+            else{
+                cur_node = cur_node->right_node;
+            }
+        }
+    }
+    return bound_node;
+}
+
+/**
+ * @brief Common wrapper of the bound queries
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param get_node [out] Found node
+ * @param bound_mode One of RBNODE_BOUND_*
+ * @return Operation status code
+ */
+static hyrbtree_ret_t hyrbtree_bound_node( hyrbtree_t *tree,void *elem,void **get_node,hy_u8_t bound_mode ){
+    hyrbnode_t *bound_node;
+
+    if( tree->root_node!=&tree->nil_node ){
+        bound_node = hyrbtree_bound_rbnode(tree,elem,bound_mode);
+        if( bound_node!=&tree->nil_node ){
+            *get_node = hyrbtree_rbnode_to_user(tree,bound_node);
+            return HYRBTREE_RET_OK;
+        }
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+    return HYRBTREE_RET_GET_NODE_TREE_NULL;
+}
+
+/**
+ * @brief Find the first node whose key is not less than elem
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param get_node [out] Found node
+ * @return Operation status code
+ * 
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: All keys are less than elem
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_lower_bound( hyrbtree_t *tree,void *elem,void **get_node ){
+    return hyrbtree_bound_node( tree,elem,get_node,RBNODE_BOUND_LOWER );
+}
+
+/**
+ * @brief Find the first node whose key is greater than elem
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_lower_bound)
+ */
+hyrbtree_ret_t hyrbtree_upper_bound( hyrbtree_t *tree,void *elem,void **get_node ){
+    return hyrbtree_bound_node( tree,elem,get_node,RBNODE_BOUND_UPPER );
+}
+
+/**
+ * @brief Find the last node whose key is not greater than elem
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_lower_bound)
+ * 
+ * Answers "latest entry at or before elem" in one descent.
+ */
+hyrbtree_ret_t hyrbtree_floor( hyrbtree_t *tree,void *elem,void **get_node ){
+    return hyrbtree_bound_node( tree,elem,get_node,RBNODE_BOUND_FLOOR );
+}
+
+/**
+ * @brief Find the smallest node whose key is not less than elem
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_lower_bound)
+ * 
+ * Same result as hyrbtree_lower_bound, provided as the mirror of hyrbtree_floor.
+ */
+hyrbtree_ret_t hyrbtree_ceiling( hyrbtree_t *tree,void *elem,void **get_node ){
+    return hyrbtree_bound_node( tree,elem,get_node,RBNODE_BOUND_LOWER );
+}
+
+/**
+ * @brief Find the first and last nodes holding a key
+ * @param tree Tree structure
+ * @param elem Key to search for
+ * @param first_node [out] First node holding elem
+ * @param last_node [out] Last node holding elem (may be HY_NULL)
+ * @return Operation status code
+ * 
+ * Meant for multimap mode: the duplicates run from first_node to last_node
+ * through hyrbtree_next, in insertion order. Two bound descents, however
+ * many duplicates there are.
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Not found
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_equal_range( hyrbtree_t *tree,void *elem,void **first_node,void **last_node ){
+    hyrbnode_t *bound_node;
+
+    if( tree->root_node!=&tree->nil_node ){
+        bound_node = hyrbtree_bound_rbnode(tree,elem,RBNODE_BOUND_LOWER);
+        if( bound_node==&tree->nil_node ||
+            hyrbtree_cmp_rbnode(tree,elem,hyrbtree_elem_cache(tree,elem),bound_node)!=0 ){
+            return HYRBTREE_RET_GET_NODE_NOT_FIND;
+        }
+        *first_node = hyrbtree_rbnode_to_user(tree,bound_node);
+        if( last_node!=HY_NULL ){
+            bound_node = hyrbtree_bound_rbnode(tree,elem,RBNODE_BOUND_FLOOR);
+            *last_node = hyrbtree_rbnode_to_user(tree,bound_node);
+        }
+        return HYRBTREE_RET_OK;
+    }
+    return HYRBTREE_RET_GET_NODE_TREE_NULL;
+}
+
+/**
+ * @brief Visit all nodes with keys in [lo_elem,hi_elem] in order
+ * @param tree Tree structure
+ * @param lo_elem Lower key (inclusive), HY_NULL for no lower limit
+ * @param hi_elem Upper key (inclusive), HY_NULL for no upper limit
+ * @param visit Callback, returns non-zero to stop the scan
+ * @param arg User argument passed to visit
+ * @return Operation status code
+ * 
+ * Both ends are located with one bound descent each, the scan itself makes
+ * no comparisons. visit may delete the node it is given. A range with
+ * lo_elem after hi_elem visits nothing.
+ * Returns:
+ * - HYRBTREE_RET_OK: Scan finished or stopped by visit
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_range_scan( hyrbtree_t *tree,void *lo_elem,void *hi_elem,
+    hyrbtree_visit_t visit,void *arg ){
+
+    hyrbnode_t *cur_node;
+    hyrbnode_t *next_node;
+    hyrbnode_t *end_node;
+
+    if( tree->root_node!=&tree->nil_node ){
+        /* An inverted range is empty; its start node would lie past the end node */
+        if( lo_elem!=HY_NULL && hi_elem!=HY_NULL && tree->cmp_elem(lo_elem,hi_elem)>0 ){
+            return HYRBTREE_RET_OK;
+        }
+        if( lo_elem!=HY_NULL ){
+            cur_node = hyrbtree_bound_rbnode(tree,lo_elem,RBNODE_BOUND_LOWER);
+        }
+        else{
+            cur_node = tree->first_node;
+        }
+
+        end_node = &tree->nil_node;
+        if( hi_elem!=HY_NULL ){
+            end_node = hyrbtree_bound_rbnode(tree,hi_elem,RBNODE_BOUND_UPPER);
+        }
+
+        while( cur_node!=end_node && cur_node!=&tree->nil_node ){
+            next_node = hyrbtree_next_rbnode(tree,cur_node);
+            if( visit(hyrbtree_rbnode_to_user(tree,cur_node),arg)!=0 ){
+                break;
+            }
+            cur_node = next_node;
+        }
+        return HYRBTREE_RET_OK;
+    }
+    return HYRBTREE_RET_GET_NODE_TREE_NULL;
+}
+
+
+
+/**
+ * @brief Recursively link the next node_num source nodes as a balanced subtree
+ * @param tree Tree structure
+ * @param parent_node Parent of the subtree root
+ * @param node_num Number of nodes in the subtree
+ * @param depth Depth of the subtree root
+ * @param red_depth Depth colored red (deepest level), 0 for none
+ * @param next_node Source callback returning the next container in key order
+ * @param arg User argument passed to next_node
+ * @return Subtree root, nil_node if node_num is 0, HY_NULL if next_node failed
+ * 
+ * The midpoint split fills every level but the deepest one, so coloring
+ * exactly that level red yields a valid R-B tree without any comparison.
+ */
+static hyrbnode_t *hyrbtree_build_subtree( hyrbtree_t *tree,hyrbnode_t *parent_node,
+    hy_u32_t node_num,hy_u8_t depth,hy_u8_t red_depth,
+    void *(*next_node)(void *arg),void *arg ){
+
+    hyrbnode_t *node;
+    hyrbnode_t *left_node;
+    void *user_node;
+    hy_u32_t left_num;
+
+    if( node_num==0 ){
+        return &tree->nil_node;
+    }
+
+    left_num = (node_num-1)/2;
+    left_node = hyrbtree_build_subtree( tree,HY_NULL,left_num,depth+1,red_depth,next_node,arg );
+    if( left_node==HY_NULL ){
+        return HY_NULL;
+    }
+
+    user_node = next_node(arg);
+    if( user_node==HY_NULL ){
+        return HY_NULL;
+    }
+    node = hyrbtree_user_to_rbnode(tree,user_node);
+    node->user_node = user_node;
+#if HYRBTREE_CFG_KEY_CACHE
+    node->elem_cache = hyrbtree_elem_cache( tree,hyrbtree_user_to_elem(tree,user_node) );
+#endif
+    if( red_depth==0 || depth!=red_depth ){
+        HYRBTREE_SET_NODE_BLACK(node);
+    }
+    node->parent_node = parent_node;
+    node->left_node = left_node;
+    if( left_node!=&tree->nil_node ){
+        left_node->parent_node = node;
+    }
+    node->right_node = hyrbtree_build_subtree( tree,node,node_num-1-left_num,depth+1,red_depth,next_node,arg );
+    if( node->right_node==HY_NULL ){
+        return HY_NULL;
+    }
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    node->subtree_size = node_num;
+#endif
+    if( tree->augment_node!=HY_NULL ){
+        hyrbtree_augment_rbnode(tree,node);
+    }
+    return node;
+}
+
+/**
+ * @brief Link source nodes into an empty tree in O(n)
+ * @param tree Tree structure (empty)
+ * @param node_num Number of nodes provided by next_node
+ * @param next_node Source callback returning the next container in key order
+ * @param arg User argument passed to next_node
+ * @return Non-zero on success, 0 if next_node failed (tree left empty)
+ */
+static hy_u8_t hyrbtree_build_tree( hyrbtree_t *tree,hy_u32_t node_num,
+    void *(*next_node)(void *arg),void *arg ){
+
+    hyrbnode_t *root_node;
+    hy_u8_t red_depth;
+    hy_u32_t level_num;
+
+    red_depth = 0;
+    for( level_num=node_num;level_num>1;level_num=level_num>>1 ){
+        red_depth++;
+    }
+
+    root_node = hyrbtree_build_subtree( tree,&tree->nil_node,node_num,0,red_depth,next_node,arg );
+    if( root_node==HY_NULL ){
+        return 0;
+    }
+    tree->root_node = root_node;
+    tree->node_count = node_num;
+    if( tree->root_node!=&tree->nil_node ){
+        tree->nil_node.left_node = tree->root_node;
+        tree->first_node = root_node;
+        while( tree->first_node->left_node!=&tree->nil_node ){
+            tree->first_node = tree->first_node->left_node;
+        }
+        tree->last_node = root_node;
+        while( tree->last_node->right_node!=&tree->nil_node ){
+            tree->last_node = tree->last_node->right_node;
+        }
+    }
+    return 1;
+}
+
+/* Array source used by hyrbtree_build_sorted */
+typedef struct{
+    void **user_nodes;
+    hy_u32_t read_pos;
+}hyrbtree_array_source_t;
+
+static void *hyrbtree_array_next_node( void *arg ){
+    hyrbtree_array_source_t *source;
+
+    source = (hyrbtree_array_source_t *)arg;
+    return source->user_nodes[ source->read_pos++ ];
+}
+
+/**
+ * @brief Build a balanced tree from nodes already sorted by key
+ * @param tree Tree structure (initialized and empty)
+ * @param user_nodes Containers in non-decreasing key order when multi_elem
+ *        is set, strictly increasing otherwise
+ * @param node_num Number of containers
+ * @return Operation status code
+ * 
+ * Links the nodes in O(n) without calling cmp_elem. The order is trusted:
+ * unsorted input, or duplicates without multi_elem, produces an invalid
+ * tree. In multimap mode equal keys keep their input order; lookups and
+ * later inserts do not depend on which side of a node its duplicates land.
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_BUILD_TREE_NOT_EMPTY: Tree already holds nodes
+ * - HYRBTREE_RET_BUILD_NODE_UNINITIALIZED: A node is already linked
+ */
+hyrbtree_ret_t hyrbtree_build_sorted( hyrbtree_t *tree,void **user_nodes,hy_u32_t node_num ){
+    hyrbtree_array_source_t source;
+    hy_u32_t i;
+
+    if( tree->root_node!=&tree->nil_node ){
+        return HYRBTREE_RET_BUILD_TREE_NOT_EMPTY;
+    }
+    for( i=0;i<node_num;i++ ){
+        if( HYRBTREE_GET_NODE_ADDR(hyrbtree_user_to_rbnode(tree,user_nodes[i]))!=HY_NULL ){
+            return HYRBTREE_RET_BUILD_NODE_UNINITIALIZED;
+        }
+    }
+
+    source.user_nodes = user_nodes;
+    source.read_pos = 0;
+    hyrbtree_build_tree( tree,node_num,hyrbtree_array_next_node,&source );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Build a balanced tree from a sequential source of sorted nodes
+ * @param tree Tree structure (initialized and empty)
+ * @param node_num Number of containers next_node will return
+ * @param next_node Source callback returning the next unlinked container in
+ *        non-decreasing key order when multi_elem is set (strictly increasing
+ *        otherwise), HY_NULL on failure
+ * @param arg User argument passed to next_node
+ * @return Operation status code
+ * 
+ * Same O(n), comparison-free linking as hyrbtree_build_sorted, but the
+ * containers are pulled one at a time, so they can be produced while
+ * reading a stream. On failure the tree is left empty and the containers
+ * already returned must be re-initialized before reuse.
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_BUILD_TREE_NOT_EMPTY: Tree already holds nodes
+ * - HYRBTREE_RET_BUILD_SOURCE_ERROR: next_node returned HY_NULL
+ */
+hyrbtree_ret_t hyrbtree_build_stream( hyrbtree_t *tree,hy_u32_t node_num,
+    void *(*next_node)(void *arg),void *arg ){
+
+    if( tree->root_node!=&tree->nil_node ){
+        return HYRBTREE_RET_BUILD_TREE_NOT_EMPTY;
+    }
+    if( hyrbtree_build_tree( tree,node_num,next_node,arg )==0 ){
+        return HYRBTREE_RET_BUILD_SOURCE_ERROR;
+    }
+    return HYRBTREE_RET_OK;
+}
+
+
+
+/**
+ * @brief Descend from a subtree root towards a key
+ * @param tree Tree structure
+ * @param cur_node Subtree root to start from (may be nil_node)
+ * @param elem Key to search for
+ * @param elem_cache Cached prefix of elem
+ * @param parent_node [in,out] Parent of cur_node on entry, leaf parent on exit
+ * @param result [in,out] Side of cur_node under parent_node on entry, last comparison on exit
+ * @return Node holding elem, nil_node if absent
+ * 
+ * On a miss, parent_node/result are ready for hyrbtree_link_node.
+ */
+static hyrbnode_t *hyrbtree_descend_rbnode( hyrbtree_t *tree,hyrbnode_t *cur_node,
+    void *elem,hy_u64_t elem_cache,hyrbnode_t **parent_node,hy_i32_t *result ){
+
+    while( cur_node!=&tree->nil_node ){
+        *parent_node = cur_node;
+        *result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,cur_node);
+        if( *result<0 ){
+            cur_node = cur_node->left_node;
+        }
+        else if( *result>0 ){
+            cur_node = cur_node->right_node;
+        }
+        else{
+            return cur_node;
+        }
+    }
+    return &tree->nil_node;
+}
+
+/**
+ * @brief Find the leaf position after every node holding a key
+ * @param tree Tree structure
+ * @param elem Key to insert
+ * @param elem_cache Cached prefix of elem
+ * @param parent_node [out] Leaf parent for hyrbtree_link_node
+ * @param result [out] Side under parent_node for hyrbtree_link_node
+ * 
+ * Multimap insertion: equal keys descend right, so the new node follows
+ * its duplicates.
+ */
+static void hyrbtree_descend_after_rbnode( hyrbtree_t *tree,void *elem,hy_u64_t elem_cache,
+    hyrbnode_t **parent_node,hy_i32_t *result ){
+
+    hyrbnode_t *cur_node;
+
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        *parent_node = cur_node;
+        *result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,cur_node);
+        if( *result<0 ){
+            cur_node = cur_node->left_node;
+        }
+        else{
+            *result = 1;
+            cur_node = cur_node->right_node;
+        }
+    }
+}
+
+/**
+ * @brief Search for a key starting from a linked node instead of the root
+ * @param tree Tree structure
+ * @param hint_node Linked rbnode close to the key
+ * @param elem Key to search for
+ * @param elem_cache Cached prefix of elem
+ * @param parent_node [out] Leaf parent on a miss
+ * @param result [out] Last comparison on a miss
+ * @return Node holding elem, nil_node if absent
+ * 
+ * Climbs parent links only until an ancestor bounds the key on the far side,
+ * comparing at those bounding ancestors only, then descends. A key adjacent
+ * to the hint costs one or two comparisons; a key past a hint at the first
+ * or last node is placed beside it in O(1), without climbing.
+ */
+static hyrbnode_t *hyrbtree_search_near_rbnode( hyrbtree_t *tree,hyrbnode_t *hint_node,
+    void *elem,hy_u64_t elem_cache,hyrbnode_t **parent_node,hy_i32_t *result ){
+
+    hyrbnode_t *cur_node;
+    hyrbnode_t *bound_node;
+    hy_i32_t hint_result;
+    hy_i32_t bound_result;
+
+    hint_result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,hint_node);
+    if( hint_result==0 ){
+        return hint_node;
+    }
+    /* Past an extreme node: its outer child is the leaf slot, no climb needed */
+    if( (hint_result>0 && hint_node==tree->last_node) || (hint_result<0 && hint_node==tree->first_node) ){
+        *parent_node = hint_node;
+        *result = hint_result;
+        return &tree->nil_node;
+    }
+
+    /* Invariant: elem lies on the hint_result side of cur_node */
+    cur_node = hint_node;
+    while(1){
+        bound_node = cur_node;
+        if( hint_result>0 ){
+            while( bound_node->parent_node!=&tree->nil_node && bound_node==bound_node->parent_node->right_node ){
+                bound_node = bound_node->parent_node;
+            }
+        }
+        else{
+            while( bound_node->parent_node!=&tree->nil_node && bound_node==bound_node->parent_node->left_node ){
+                bound_node = bound_node->parent_node;
+            }
+        }
+        bound_node = bound_node->parent_node;
+        if( bound_node==&tree->nil_node ){
+            break;
+        }
+
+        bound_result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,bound_node);
+        if( bound_result==0 ){
+            return bound_node;
+        }
+        if( (bound_result>0)!=(hint_result>0) ){
+            break;
+        }
+        cur_node = bound_node;
+    }
+
+    *parent_node = cur_node;
+    *result = hint_result;
+    cur_node = (hint_result<0) ? cur_node->left_node : cur_node->right_node;
+    return hyrbtree_descend_rbnode( tree,cur_node,elem,elem_cache,parent_node,result );
+}
+
+/**
+ * @brief Compare the keys of two containers
+ * @param tree Tree structure
+ * @param user_node1 First container
+ * @param user_node2 Second container
+ * @return cmp_elem result
+ */
+static inline hy_i32_t hyrbtree_cmp_user( hyrbtree_t *tree,void *user_node1,void *user_node2 ){
+    return tree->cmp_elem( hyrbtree_user_to_elem(tree,user_node1),hyrbtree_user_to_elem(tree,user_node2) );
+}
+
+/**
+ * @brief Restore the max-heap property below one entry
+ * @param tree Tree structure
+ * @param user_nodes Heap array
+ * @param root_pos Entry to sift down
+ * @param node_num Heap size
+ */
+static void hyrbtree_sift_nodes( hyrbtree_t *tree,void **user_nodes,hy_u32_t root_pos,hy_u32_t node_num ){
+    hy_u32_t child_pos;
+    void *user_node;
+
+    user_node = user_nodes[root_pos];
+    while( (child_pos=root_pos*2+1)<node_num ){
+        if( child_pos+1<node_num && hyrbtree_cmp_user(tree,user_nodes[child_pos],user_nodes[child_pos+1])<0 ){
+            child_pos++;
+        }
+        if( hyrbtree_cmp_user(tree,user_node,user_nodes[child_pos])>=0 ){
+            break;
+        }
+        user_nodes[root_pos] = user_nodes[child_pos];
+        root_pos = child_pos;
+    }
+    user_nodes[root_pos] = user_node;
+}
+
+/**
+ * @brief Sort containers by key in place
+ * @param tree Tree structure
+ * @param user_nodes Containers to sort
+ * @param node_num Container count
+ * 
+ * Heap sort: O(n log n) comparisons with no allocation.
+ */
+static void hyrbtree_sort_nodes( hyrbtree_t *tree,void **user_nodes,hy_u32_t node_num ){
+    hy_u32_t i;
+    void *user_node;
+
+    for( i=node_num/2;i>0;i-- ){
+        hyrbtree_sift_nodes( tree,user_nodes,i-1,node_num );
+    }
+    for( i=node_num;i>1;i-- ){
+        user_node = user_nodes[0];
+        user_nodes[0] = user_nodes[i-1];
+        user_nodes[i-1] = user_node;
+        hyrbtree_sift_nodes( tree,user_nodes,0,i-1 );
+    }
+}
+
+/**
+ * @brief Insert a batch of nodes, each descent starting from the previous one
+ * @param tree Tree structure
+ * @param user_nodes Containers to insert
+ * @param node_num Container count
+ * @param exist_nodes [out] Per container: existing node on key collision, else HY_NULL (may be HY_NULL)
+ * @param sort_nodes Non-zero to sort user_nodes by key first
+ * @return Operation status code
+ * 
+ * Each search climbs from the previous landing node only until the subtree
+ * covers the key, then descends. Clustered batches cost about log(gap)
+ * comparisons per insert instead of log(n). In multimap mode a duplicate
+ * key is linked after its equals with one extra descent from the root;
+ * sorting is not stable, so duplicates inside one sorted batch may be
+ * reordered.
+ * Returns:
+ * - HYRBTREE_RET_OK: Batch processed, collisions reported in exist_nodes
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: A node is already linked, nothing inserted
+ */
+hyrbtree_ret_t hyrbtree_add_nodes( hyrbtree_t *tree,void **user_nodes,hy_u32_t node_num,
+    void **exist_nodes,hy_u8_t sort_nodes ){
+
+    hyrbnode_t *add_node;
+    hyrbnode_t *finger_node;
+    hyrbnode_t *parent_node;
+    hyrbnode_t *exist_node;
+    void *add_node_elem;
+    hy_u64_t add_node_cache;
+    hy_i32_t result;
+    hy_u32_t i;
+
+    for( i=0;i<node_num;i++ ){
+        if( HYRBTREE_GET_NODE_ADDR(hyrbtree_user_to_rbnode(tree,user_nodes[i]))!=HY_NULL ){
+            return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+        }
+    }
+    if( sort_nodes!=0 ){
+        hyrbtree_sort_nodes( tree,user_nodes,node_num );
+    }
+
+    finger_node = &tree->nil_node;
+    for( i=0;i<node_num;i++ ){
+        add_node = hyrbtree_user_to_rbnode(tree,user_nodes[i]);
+        add_node_elem = hyrbtree_user_to_elem(tree,user_nodes[i]);
+        add_node_cache = hyrbtree_elem_cache(tree,add_node_elem);
+
+        parent_node = &tree->nil_node;
+        result = 0;
+        if( finger_node!=&tree->nil_node ){
+            exist_node = hyrbtree_search_near_rbnode( tree,finger_node,add_node_elem,add_node_cache,&parent_node,&result );
+        }
+        else{
+            exist_node = hyrbtree_descend_rbnode( tree,tree->root_node,add_node_elem,add_node_cache,&parent_node,&result );
+        }
+
+        if( exist_node!=&tree->nil_node && tree->multi_elem!=0 ){
+            hyrbtree_descend_after_rbnode( tree,add_node_elem,add_node_cache,&parent_node,&result );
+            exist_node = &tree->nil_node;
+        }
+        if( exist_node==&tree->nil_node ){
+            hyrbtree_link_node( tree,add_node,user_nodes[i],parent_node,result );
+            finger_node = add_node;
+            if( exist_nodes!=HY_NULL ){
+                exist_nodes[i] = HY_NULL;
+            }
+        }
+        else{
+            finger_node = exist_node;
+            if( exist_nodes!=HY_NULL ){
+                exist_nodes[i] = hyrbtree_rbnode_to_user(tree,exist_node);
+            }
+        }
+    }
+    return HYRBTREE_RET_OK;
+}
+
+
+
+/**
+ * @brief Insert a node, searching from a nearby linked node
+ * @param tree Tree structure
+ * @param hint_node Container linked in tree close to the new key, HY_NULL for root
+ * @param user_node User data containing embedded rbnode
+ * @param exist_node [out] Returns existing node if key exists
+ * @return Operation status code (see hyrbtree_add_node)
+ * 
+ * Appending a key larger than a hint at the rightmost node (or smaller than
+ * one at the leftmost node) costs a single comparison and no descent. In
+ * multimap mode a duplicate key falls back to a descent from the root,
+ * unless it duplicates the last node.
+ */
+hyrbtree_ret_t hyrbtree_add_node_hint( hyrbtree_t *tree,void *hint_node,void *user_node,void **exist_node ){
+    hyrbnode_t *add_node;
+    hyrbnode_t *found_node;
+    hyrbnode_t *parent_node;
+    void *add_node_elem;
+    hy_u64_t add_node_cache;
+    hy_i32_t result;
+
+    add_node = hyrbtree_user_to_rbnode(tree,user_node);
+    if( HYRBTREE_GET_NODE_ADDR(add_node)==HY_NULL ){
+        add_node_elem = hyrbtree_user_to_elem(tree,user_node);
+        add_node_cache = hyrbtree_elem_cache(tree,add_node_elem);
+        parent_node = &tree->nil_node;
+        result = 0;
+
+        if( hint_node!=HY_NULL ){
+            found_node = hyrbtree_search_near_rbnode( tree,hyrbtree_user_to_rbnode(tree,hint_node),
+                add_node_elem,add_node_cache,&parent_node,&result );
+        }
+        else{
+            found_node = hyrbtree_descend_rbnode( tree,tree->root_node,
+                add_node_elem,add_node_cache,&parent_node,&result );
+        }
+
+        if( found_node!=&tree->nil_node ){
+            if( tree->multi_elem==0 ){
+                *exist_node = hyrbtree_rbnode_to_user(tree,found_node);
+                return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
+            }
+            /* A duplicate of the last node goes straight after it */
+            if( found_node==tree->last_node ){
+                parent_node = found_node;
+                result = 1;
+            }
+            else{
+                hyrbtree_descend_after_rbnode( tree,add_node_elem,add_node_cache,&parent_node,&result );
+            }
+        }
+        hyrbtree_link_node( tree,add_node,user_node,parent_node,result );
+        return HYRBTREE_RET_OK;
+    }
+    return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+}
+
+/**
+ * @brief Search for a node by key, starting from a nearby linked node
+ * @param tree Tree structure
+ * @param hint_node Container linked in tree close to the key, HY_NULL for root
+ * @param get_node_elem Key to search for
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_get_node)
+ * 
+ * In multimap mode a hit is resolved to the first duplicate from the root.
+ */
+hyrbtree_ret_t hyrbtree_get_node_hint( hyrbtree_t *tree,void *hint_node,void *get_node_elem,void **get_node ){
+    hyrbnode_t *found_node;
+    hyrbnode_t *parent_node;
+    hy_u64_t get_node_cache;
+    hy_i32_t result;
+
+    if( tree->root_node!=&tree->nil_node ){
+        get_node_cache = hyrbtree_elem_cache(tree,get_node_elem);
+        if( hint_node!=HY_NULL ){
+            found_node = hyrbtree_search_near_rbnode( tree,hyrbtree_user_to_rbnode(tree,hint_node),
+                get_node_elem,get_node_cache,&parent_node,&result );
+        }
+        else{
+            found_node = hyrbtree_descend_rbnode( tree,tree->root_node,
+                get_node_elem,get_node_cache,&parent_node,&result );
+        }
+
+        if( found_node!=&tree->nil_node ){
+            if( tree->multi_elem!=0 ){
+                return hyrbtree_equal_range( tree,get_node_elem,get_node,HY_NULL );
+            }
+            *get_node = hyrbtree_rbnode_to_user(tree,found_node);
+            return HYRBTREE_RET_OK;
+        }
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+    return HYRBTREE_RET_GET_NODE_TREE_NULL;
+}
+
+/**
+ * @brief Change the key of a linked node
+ * @param tree Tree structure
+ * @param user_node Container currently linked in tree
+ * @param elem New key
+ * @param update Stores elem as the key of user_node
+ * @param exist_node [out] Returns the node already holding the new key
+ * @return Operation status code
+ * 
+ * The new key is checked against the in-order neighbors before update is
+ * called: while prev < key < next (prev <= key < next in multimap mode,
+ * so the node still follows its duplicates) the node stays where it is and
+ * only its key cache and aggregates are refreshed. Otherwise the node is
+ * re-linked from the neighbor on the side it moved to, climbing only as far
+ * as the new key requires; a key moved past the first or last node is
+ * placed beside it directly. In a unique tree the new key is searched for
+ * while the node is still linked, and the leaf found is reused when the
+ * unlink left it free.
+ * Returns:
+ * - HYRBTREE_RET_OK: Rekeyed
+ * - HYRBTREE_RET_DEL_NODE_ARGS_ERROR: Node not linked (update not called)
+ * - HYRBTREE_RET_ADD_NODE_ELEM_EXIST: New key already present (update not
+ *   called, user_node left linked under its old key)
+ */
+hyrbtree_ret_t hyrbtree_rekey_node( hyrbtree_t *tree,void *user_node,void *elem,
+    hyrbtree_update_t update,void **exist_node ){
+
+    hyrbnode_t *node;
+    hyrbnode_t *prev_node;
+    hyrbnode_t *next_node;
+    hyrbnode_t *hint_node;
+    hyrbnode_t *found_node;
+    hyrbnode_t *parent_node;
+    hy_u64_t elem_cache;
+    hy_i32_t prev_result;
+    hy_i32_t next_result;
+    hy_i32_t result;
+
+    node = hyrbtree_user_to_rbnode(tree,user_node);
+    if( HYRBTREE_GET_NODE_ADDR(node)!=user_node ){
+        return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
+    }
+    prev_node = hyrbtree_prev_rbnode(tree,node);
+    next_node = hyrbtree_next_rbnode(tree,node);
+
+    elem_cache = hyrbtree_elem_cache(tree,elem);
+    prev_result = 1;
+    if( prev_node!=&tree->nil_node ){
+        prev_result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,prev_node);
+    }
+    next_result = -1;
+    if( next_node!=&tree->nil_node && (prev_result>0 || (prev_result==0 && tree->multi_elem!=0)) ){
+        next_result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,next_node);
+    }
+
+    if( next_result<0 && (prev_result>0 || (prev_result==0 && tree->multi_elem!=0)) ){
+        update( user_node,elem );
+#if HYRBTREE_CFG_KEY_CACHE
+        node->elem_cache = elem_cache;
+#endif
+        hyrbtree_augment_path( tree,node,1 );
+        return HYRBTREE_RET_OK;
+    }
+
+    /* Relocate from the neighbor on the new side, or the extreme node past it */
+    if( next_result>=0 ){
+        hint_node = next_node;
+        if( next_node!=tree->last_node && hyrbtree_cmp_rbnode(tree,elem,elem_cache,tree->last_node)>=0 ){
+            hint_node = tree->last_node;
+        }
+    }
+    else{
+        hint_node = prev_node;
+        if( prev_node!=tree->first_node && hyrbtree_cmp_rbnode(tree,elem,elem_cache,tree->first_node)<0 ){
+            hint_node = tree->first_node;
+        }
+    }
+
+    if( tree->multi_elem!=0 ){
+        hyrbtree_unlink_node( tree,node );
+        update( user_node,elem );
+        return hyrbtree_add_node_hint( tree,hyrbtree_rbnode_to_user(tree,hint_node),user_node,exist_node );
+    }
+
+    /* The search from the hint stays on the far side of node, so node's stale key is never compared */
+    found_node = hyrbtree_search_near_rbnode( tree,hint_node,elem,elem_cache,&parent_node,&result );
+    if( found_node!=&tree->nil_node ){
+        *exist_node = hyrbtree_rbnode_to_user(tree,found_node);
+        return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
+    }
+    hyrbtree_unlink_node( tree,node );
+    update( user_node,elem );
+    if( ((result<0) ? parent_node->left_node : parent_node->right_node)==&tree->nil_node ){
+        hyrbtree_link_node( tree,node,user_node,parent_node,result );
+        return HYRBTREE_RET_OK;
+    }
+    return hyrbtree_add_node_hint( tree,hyrbtree_rbnode_to_user(tree,parent_node),user_node,exist_node );
+}
+
+
+
+/**
+ * @brief Get the number of linked nodes
+ * @param tree Tree structure
+ * @return Node count, O(1)
+ */
+hy_u32_t hyrbtree_count( hyrbtree_t *tree ){
+    return tree->node_count;
+}
+
+#if HYRBTREE_CFG_SUBTREE_SIZE
+/**
+ * @brief Find the node at a given position in key order
+ * @param tree Tree structure
+ * @param rank 0-based position
+ * @param get_node [out] Found node
+ * @return Operation status code
+ * 
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: rank >= node count
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_select( hyrbtree_t *tree,hy_u32_t rank,void **get_node ){
+    hyrbnode_t *cur_node;
+    hy_u32_t left_size;
+
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    if( rank>=tree->root_node->subtree_size ){
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+
+    cur_node = tree->root_node;
+    while(1){
+        left_size = cur_node->left_node->subtree_size;
+        if( rank<left_size ){
+            cur_node = cur_node->left_node;
+        }
+        else if( rank>left_size ){
+            rank = rank-left_size-1;
+            cur_node = cur_node->right_node;
+        }
+        else{
+            *get_node = hyrbtree_rbnode_to_user(tree,cur_node);
+            return HYRBTREE_RET_OK;
+        }
+    }
+}
+
+/**
+ * @brief Count the nodes whose key is less than elem
+ * @param tree Tree structure
+ * @param elem Key to rank
+ * @param rank [out] Number of keys less than elem (0-based position if present)
+ * @return Operation status code
+ * 
+ * rank is set in every case, so it also gives the insertion position.
+ * Returns:
+ * - HYRBTREE_RET_OK: elem is present
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: elem is absent
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_rank( hyrbtree_t *tree,void *elem,hy_u32_t *rank ){
+    hyrbnode_t *cur_node;
+    hy_u64_t elem_cache;
+    hy_i32_t result;
+    hyrbtree_ret_t ret;
+
+    *rank = 0;
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    ret = HYRBTREE_RET_GET_NODE_NOT_FIND;
+    elem_cache = hyrbtree_elem_cache(tree,elem);
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        result = hyrbtree_cmp_rbnode(tree,elem,elem_cache,cur_node);
+        if( result<0 ){
+            cur_node = cur_node->left_node;
+        }
+        else if( result>0 ){
+            *rank = *rank+cur_node->left_node->subtree_size+1;
+            cur_node = cur_node->right_node;
+        }
+        else if( tree->multi_elem!=0 ){
+            /* Keep looking left for the first duplicate */
+            ret = HYRBTREE_RET_OK;
+            cur_node = cur_node->left_node;
+        }
+        else{
+            *rank = *rank+cur_node->left_node->subtree_size;
+            return HYRBTREE_RET_OK;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Get the position of a linked node in key order
+ * @param tree Tree structure
+ * @param user_node Container currently linked in tree
+ * @return 0-based position
+ * 
+ * Climbs parent links, no comparisons.
+ */
+hy_u32_t hyrbtree_node_rank( hyrbtree_t *tree,void *user_node ){
+    hyrbnode_t *node;
+    hy_u32_t rank;
+
+    node = hyrbtree_user_to_rbnode(tree,user_node);
+    rank = node->left_node->subtree_size;
+    while( node->parent_node!=&tree->nil_node ){
+        if( node==node->parent_node->right_node ){
+            rank = rank+node->parent_node->left_node->subtree_size+1;
+        }
+        node = node->parent_node;
+    }
+    return rank;
+}
+#endif
+
+
+
+/**
+ * @brief Refresh aggregates after a node's own value changed
+ * @param tree Tree structure
+ * @param user_node Container currently linked in tree
+ *
+ * Call after modifying data that augment_node folds in (not the key).
+ * Recomputes from the node up to the root, stopping once an aggregate
+ * is unchanged.
+ */
+void hyrbtree_augment_update( hyrbtree_t *tree,void *user_node ){
+    hyrbtree_augment_path( tree,hyrbtree_user_to_rbnode(tree,user_node),1 );
+}
+
+/**
+ * @brief Fold the aggregate of all keys in [lo_elem,hi_elem]
+ * @param tree Tree structure (augment_node registered)
+ * @param lo_elem Inclusive lower key, HY_NULL for unbounded
+ * @param hi_elem Inclusive upper key, HY_NULL for unbounded
+ * @param collect Called once per contributing node or whole subtree
+ * @param arg User argument passed to collect
+ * @return Operation status code
+ *
+ * Descends to the node where the bounds split, then walks both boundary
+ * paths, so collect runs O(log n) times. Contributions arrive in no
+ * particular order; the fold must be commutative (sum, min, max...).
+ * Returns:
+ * - HYRBTREE_RET_OK: Aggregate complete (possibly no contributions)
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_range_aggregate( hyrbtree_t *tree,void *lo_elem,void *hi_elem,
+    hyrbtree_collect_t collect,void *arg ){
+
+    hyrbnode_t *split_node;
+    hyrbnode_t *cur_node;
+    hy_u64_t lo_cache;
+    hy_u64_t hi_cache;
+
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    lo_cache = lo_elem!=HY_NULL ? hyrbtree_elem_cache(tree,lo_elem) : 0;
+    hi_cache = hi_elem!=HY_NULL ? hyrbtree_elem_cache(tree,hi_elem) : 0;
+
+    split_node = tree->root_node;
+    while( split_node!=&tree->nil_node ){
+        if( lo_elem!=HY_NULL && hyrbtree_cmp_rbnode(tree,lo_elem,lo_cache,split_node)>0 ){
+            split_node = split_node->right_node;
+        }
+        else if( hi_elem!=HY_NULL && hyrbtree_cmp_rbnode(tree,hi_elem,hi_cache,split_node)<0 ){
+            split_node = split_node->left_node;
+        }
+        else{
+            break;
+        }
+    }
+    if( split_node==&tree->nil_node ){
+        return HYRBTREE_RET_OK;
+    }
+    collect( hyrbtree_rbnode_to_user(tree,split_node),0,arg );
+
+    cur_node = split_node->left_node;
+    while( cur_node!=&tree->nil_node ){
+        if( lo_elem==HY_NULL || hyrbtree_cmp_rbnode(tree,lo_elem,lo_cache,cur_node)<=0 ){
+            collect( hyrbtree_rbnode_to_user(tree,cur_node),0,arg );
+            if( cur_node->right_node!=&tree->nil_node ){
+                collect( hyrbtree_rbnode_to_user(tree,cur_node->right_node),1,arg );
+            }
+            cur_node = cur_node->left_node;
+        }
+        else{
+            cur_node = cur_node->right_node;
+        }
+    }
+
+    cur_node = split_node->right_node;
+    while( cur_node!=&tree->nil_node ){
+        if( hi_elem==HY_NULL || hyrbtree_cmp_rbnode(tree,hi_elem,hi_cache,cur_node)>=0 ){
+            collect( hyrbtree_rbnode_to_user(tree,cur_node),0,arg );
+            if( cur_node->left_node!=&tree->nil_node ){
+                collect( hyrbtree_rbnode_to_user(tree,cur_node->left_node),1,arg );
+            }
+            cur_node = cur_node->right_node;
+        }
+        else{
+            cur_node = cur_node->left_node;
+        }
+    }
+    return HYRBTREE_RET_OK;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file hyrbtree_bench.c
+ * @brief Red-Black Tree Lookup Benchmark
+ * 
+ * Each tree is built with hyrbtree_build_sorted over nodes whose memory order
+ * is a random permutation of key order, so every descent step is a likely
+ * cache miss once the tree outgrows the caches. Lookups use random present
+ * keys; throughput is reported in million lookups per second.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "hyrbtree_bench.h"
+
+
+
+/**
+ * @brief Key comparison
+ * @param elem1 First key
+ * @param elem2 Second key
+ * @return Ordinal relationship (-1/0/+1)
+ */
+static hy_i32_t bench_node_cmp_elem( void *elem1,void *elem2 ){
+    uint64_t elem1_value;
+    uint64_t elem2_value;
+    elem1_value = *(uint64_t *)elem1;
+    elem2_value = *(uint64_t *)elem2;
+    return (elem1_value>elem2_value)-(elem1_value<elem2_value);
+}
+
+/**
+ * @brief Small xorshift generator, independent of the libc rand() range
+ * @param state Generator state
+ * @return Next pseudo-random value
+ */
+static uint64_t bench_random( uint64_t *state ){
+    *state ^= *state<<13;
+    *state ^= *state>>7;
+    *state ^= *state<<17;
+    return *state;
+}
+
+/**
+ * @brief Elapsed seconds since start
+ * @param start Start timestamp from clock()
+ * @return Elapsed processor time in seconds
+ */
+static double bench_elapsed( clock_t start ){
+    return (double)(clock()-start)/CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Benchmark one tree size
+ * @param node_num Tree size
+ * @param seed Generator state
+ * @return 0 on success, -1 on allocation failure
+ */
+static int hyrbtree_bench_size( uint32_t node_num,uint64_t *seed ){
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(bench_node_t,rbnode,elem,bench_node_cmp_elem),
+    };
+    bench_node_t *node_pool;
+    void **sorted_nodes;
+    uint64_t *query_elems;
+    void **query_ptrs;
+    void **get_nodes;
+    void *get_node;
+    uint32_t i;
+    uint32_t j;
+    uint32_t swap_pos;
+    uint64_t swap_elem;
+    uint64_t found_num;
+    clock_t start;
+    double scalar_time;
+    double batch_time;
+
+    node_pool = malloc( (size_t)node_num*sizeof(bench_node_t) );
+    sorted_nodes = malloc( (size_t)node_num*sizeof(void *) );
+    query_elems = malloc( HYRBTREE_BENCH_LOOKUPS*sizeof(uint64_t) );
+    query_ptrs = malloc( HYRBTREE_BENCH_LOOKUPS*sizeof(void *) );
+    get_nodes = malloc( HYRBTREE_BENCH_BATCH*sizeof(void *) );
+    if( node_pool==NULL || sorted_nodes==NULL || query_elems==NULL || query_ptrs==NULL || get_nodes==NULL ){
+        free( node_pool );
+        free( sorted_nodes );
+        free( query_elems );
+        free( query_ptrs );
+        free( get_nodes );
+        return -1;
+    }
+
+    /* Keys 0..n-1 scattered over the pool in random order */
+    for( i=0;i<node_num;i++ ){
+        node_pool[i].elem = i;
+    }
+    for( i=node_num-1;i>0;i-- ){
+        swap_pos = (uint32_t)(bench_random(seed)%(i+1));
+        swap_elem = node_pool[i].elem;
+        node_pool[i].elem = node_pool[swap_pos].elem;
+        node_pool[swap_pos].elem = swap_elem;
+    }
+    for( i=0;i<node_num;i++ ){
+        node_pool[i].rbnode.user_node = NULL;
+        sorted_nodes[ node_pool[i].elem ] = &node_pool[i];
+    }
+    hyrbtree_init( &rbtree );
+    hyrbtree_build_sorted( &rbtree,sorted_nodes,node_num );
+
+    for( i=0;i<HYRBTREE_BENCH_LOOKUPS;i++ ){
+        query_elems[i] = bench_random(seed)%node_num;
+        query_ptrs[i] = &query_elems[i];
+    }
+
+    found_num = 0;
+    start = clock();
+    for( i=0;i<HYRBTREE_BENCH_LOOKUPS;i++ ){
+        if( hyrbtree_get_node( &rbtree,query_ptrs[i],&get_node )==HYRBTREE_RET_OK ){
+            found_num++;
+        }
+    }
+    scalar_time = bench_elapsed(start);
+
+    start = clock();
+    for( i=0;i<HYRBTREE_BENCH_LOOKUPS;i+=HYRBTREE_BENCH_BATCH ){
+        hyrbtree_get_nodes( &rbtree,&query_ptrs[i],HYRBTREE_BENCH_BATCH,get_nodes );
+        for( j=0;j<HYRBTREE_BENCH_BATCH;j++ ){
+            if( get_nodes[j]!=NULL ){
+                found_num++;
+            }
+        }
+    }
+    batch_time = bench_elapsed(start);
+
+    printf("\nnodes=%10lu,size=%8.1fMB,scalar=%7.2fMops,batch=%7.2fMops,speedup=%5.2fx,found=%s",
+        (unsigned long)node_num,
+        (double)node_num*sizeof(bench_node_t)/(1024.0*1024.0),
+        HYRBTREE_BENCH_LOOKUPS/scalar_time/1e6,
+        HYRBTREE_BENCH_LOOKUPS/batch_time/1e6,
+        scalar_time/batch_time,
+        (found_num==2ULL*HYRBTREE_BENCH_LOOKUPS) ? "all" : "missing");
+
+    free( node_pool );
+    free( sorted_nodes );
+    free( query_elems );
+    free( query_ptrs );
+    free( get_nodes );
+    return 0;
+}
+
+/**
+ * @brief Main benchmark entry point
+ * 
+ * Runs sizes HYRBTREE_BENCH_MIN_NODES..HYRBTREE_BENCH_MAX_NODES (4x steps).
+ * Raise HYRBTREE_BENCH_MAX_NODES so the largest tree is about 100x the last
+ * level cache of the target machine.
+ */
+void hyrbtree_bench( void ){
+    unsigned long node_num;
+    uint64_t seed;
+
+    seed = 0x9E3779B97F4A7C15ULL;
+    printf("\n\nlookup benchmark (lanes=%d,batch=%d,lookups=%lu):",
+        HYRBTREE_CFG_GET_LANES,HYRBTREE_BENCH_BATCH,(unsigned long)HYRBTREE_BENCH_LOOKUPS);
+    for( node_num=HYRBTREE_BENCH_MIN_NODES;node_num<=HYRBTREE_BENCH_MAX_NODES;node_num*=4 ){
+        if( hyrbtree_bench_size( (uint32_t)node_num,&seed )!=0 ){
+            printf("\nnodes=%10lu allocation failed!",node_num);
+            break;
+        }
+    }
+    printf("\n");
+}
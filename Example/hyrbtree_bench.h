@@ -0,0 +1,55 @@
+/**
+ * @file hyrbtree_bench.h
+ * @brief Red-Black Tree Lookup Benchmark
+ * 
+ * Compares lookup throughput of:
+ * - Scalar hyrbtree_get_node loop
+ * - Interleaved hyrbtree_get_nodes batches
+ * 
+ * Tree sizes range from L2-resident to far beyond the last level cache.
+ */
+
+#ifndef HYRBTREE_BENCH_H
+#define HYRBTREE_BENCH_H
+
+#include <stdio.h>
+#include "hyrbtree.h"
+
+
+
+/** Smallest benchmarked tree (nodes) */
+#ifndef HYRBTREE_BENCH_MIN_NODES
+#define HYRBTREE_BENCH_MIN_NODES    (1UL<<12)
+#endif
+
+/** Largest benchmarked tree (nodes), sizes grow 4x per step */
+#ifndef HYRBTREE_BENCH_MAX_NODES
+#define HYRBTREE_BENCH_MAX_NODES    (1UL<<24)
+#endif
+
+/** Lookups timed per tree size and method */
+#ifndef HYRBTREE_BENCH_LOOKUPS
+#define HYRBTREE_BENCH_LOOKUPS      (1UL<<22)
+#endif
+
+/** Keys handed to one hyrbtree_get_nodes call */
+#ifndef HYRBTREE_BENCH_BATCH
+#define HYRBTREE_BENCH_BATCH        256
+#endif
+
+
+
+/**
+ * @brief Benchmark node structure
+ */
+typedef struct{
+    uint64_t elem;
+    hyrbnode_t rbnode;
+}bench_node_t;
+
+
+
+/** Entry point for benchmark execution */
+void hyrbtree_bench( void );
+
+#endif
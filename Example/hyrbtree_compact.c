@@ -0,0 +1,575 @@
+/**
+ * @file hyrbtree_compact.c
+ * @brief Parent-Free Compact Red-Black Tree Implementation
+ *
+ * Writers record the descent in a path stack (node and direction taken at
+ * each level) and rebalance by walking that stack back up; a rotation
+ * rewrites two child links and the link into the rotated subtree, with no
+ * parent links to maintain.
+ */
+
+#include "hyrbtree_compact.h"
+
+
+
+/**
+ * @brief Locate the embedded node of a container
+ * @param tree Compact tree
+ * @param user_node Container structure
+ * @return Embedded node
+ */
+static inline hyrbcnode_t *hyrbtree_compact_user_to_node( hyrbtree_compact_t *tree,void *user_node ){
+    if( tree->get_rbnode!=HY_NULL ){
+        return tree->get_rbnode(user_node);
+    }
+    return (hyrbcnode_t *)((hy_u8_t *)user_node+tree->rbnode_offset);
+}
+
+/**
+ * @brief Locate the key of a container
+ * @param tree Compact tree
+ * @param user_node Container structure
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_compact_user_to_elem( hyrbtree_compact_t *tree,void *user_node ){
+    if( tree->get_elem!=HY_NULL ){
+        return tree->get_elem(user_node);
+    }
+    return (void *)((hy_u8_t *)user_node+tree->elem_offset);
+}
+
+/**
+ * @brief Locate the key of a linked node
+ * @param tree Compact tree
+ * @param node Linked node
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_compact_node_to_elem( hyrbtree_compact_t *tree,hyrbcnode_t *node ){
+    return hyrbtree_compact_user_to_elem( tree,HYRBTREE_GET_NODE_ADDR(node) );
+}
+
+/**
+ * @brief Check node color, HY_NULL counts as black
+ * @param node Node or HY_NULL
+ * @return Non-zero if red
+ */
+static inline hy_u8_t hyrbtree_compact_is_red( hyrbcnode_t *node ){
+    return node!=HY_NULL && HYRBTREE_READ_NODE_COLOR(node)==HYRBTREE_NODE_RED;
+}
+
+/**
+ * @brief Set node color
+ * @param node Linked node
+ * @param color HYRBTREE_NODE_RED or _BLACK
+ */
+static inline void hyrbtree_compact_set_color( hyrbcnode_t *node,hy_uptr_t color ){
+    node->user_node = (void *)(((hy_uptr_t)node->user_node & ~(hy_uptr_t)0x1) | color);
+}
+
+/**
+ * @brief Get the link holding a path entry
+ * @param tree Compact tree
+ * @param path Nodes from the root
+ * @param dir Direction taken from each path entry (0 left, 1 right)
+ * @param depth Path index of the node whose link is wanted
+ * @return Link in the parent, or the root link
+ */
+static inline hyrbcnode_t **hyrbtree_compact_link( hyrbtree_compact_t *tree,hyrbcnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    if( depth<=0 ){
+        return &tree->root_node;
+    }
+    return dir[depth-1]==0 ? &path[depth-1]->left_node : &path[depth-1]->right_node;
+}
+
+/**
+ * @brief Rotate left, returning the new subtree root
+ * @param node Subtree root with a right child
+ * @return New subtree root
+ */
+static inline hyrbcnode_t *hyrbtree_compact_rotate_left( hyrbcnode_t *node ){
+    hyrbcnode_t *right_node;
+
+    right_node = node->right_node;
+    node->right_node = right_node->left_node;
+    right_node->left_node = node;
+    return right_node;
+}
+
+/**
+ * @brief Rotate right, returning the new subtree root
+ * @param node Subtree root with a left child
+ * @return New subtree root
+ */
+static inline hyrbcnode_t *hyrbtree_compact_rotate_right( hyrbcnode_t *node ){
+    hyrbcnode_t *left_node;
+
+    left_node = node->left_node;
+    node->left_node = left_node->right_node;
+    left_node->right_node = node;
+    return left_node;
+}
+
+/**
+ * @brief Restore balance after linking a red leaf
+ * @param tree Compact tree
+ * @param path Path from the root, path[depth] is the new leaf
+ * @param dir Direction taken from each path entry
+ * @param depth Path index of the new leaf
+ */
+static void hyrbtree_compact_add_balance( hyrbtree_compact_t *tree,hyrbcnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    hyrbcnode_t *parent_node;
+    hyrbcnode_t *grand_node;
+    hyrbcnode_t *uncle_node;
+
+    while( depth>=2 && hyrbtree_compact_is_red(path[depth-1]) ){
+        parent_node = path[depth-1];
+        grand_node = path[depth-2];
+        uncle_node = dir[depth-2]==0 ? grand_node->right_node : grand_node->left_node;
+        if( hyrbtree_compact_is_red(uncle_node) ){
+            hyrbtree_compact_set_color( uncle_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_compact_set_color( grand_node,HYRBTREE_NODE_RED );
+            depth -= 2;
+            continue;
+        }
+
+        if( dir[depth-2]==0 ){
+            if( dir[depth-1]==1 ){
+                grand_node->left_node = hyrbtree_compact_rotate_left( parent_node );
+                parent_node = grand_node->left_node;
+            }
+            *hyrbtree_compact_link( tree,path,dir,depth-2 ) = hyrbtree_compact_rotate_right( grand_node );
+        }
+        else{
+            if( dir[depth-1]==0 ){
+                grand_node->right_node = hyrbtree_compact_rotate_right( parent_node );
+                parent_node = grand_node->right_node;
+            }
+            *hyrbtree_compact_link( tree,path,dir,depth-2 ) = hyrbtree_compact_rotate_left( grand_node );
+        }
+        hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_BLACK );
+        hyrbtree_compact_set_color( grand_node,HYRBTREE_NODE_RED );
+        break;
+    }
+    hyrbtree_compact_set_color( tree->root_node,HYRBTREE_NODE_BLACK );
+}
+
+/**
+ * @brief Restore balance after unlinking a black node
+ * @param tree Compact tree
+ * @param path Path from the root, path[depth] is the parent of the unlinked node
+ * @param dir Direction taken from each path entry
+ * @param depth Path index of the parent, -1 if the root was unlinked
+ *
+ * The child that took the unlinked node's place (possibly HY_NULL) carries
+ * the missing black; it lies at dir[depth] below path[depth]. path must
+ * have room for one more entry.
+ */
+static void hyrbtree_compact_del_balance( hyrbtree_compact_t *tree,hyrbcnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    hyrbcnode_t *parent_node;
+    hyrbcnode_t *sibling_node;
+    hyrbcnode_t *fix_node;
+
+    fix_node = *hyrbtree_compact_link( tree,path,dir,depth+1 );
+    while( depth>=0 && !hyrbtree_compact_is_red(fix_node) ){
+        parent_node = path[depth];
+        if( dir[depth]==0 ){
+            sibling_node = parent_node->right_node;
+            if( hyrbtree_compact_is_red(sibling_node) ){
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_RED );
+                *hyrbtree_compact_link( tree,path,dir,depth ) = hyrbtree_compact_rotate_left( parent_node );
+                path[depth] = sibling_node;
+                dir[depth] = 0;
+                depth++;
+                path[depth] = parent_node;
+                dir[depth] = 0;
+                sibling_node = parent_node->right_node;
+            }
+            if( !hyrbtree_compact_is_red(sibling_node->left_node) && !hyrbtree_compact_is_red(sibling_node->right_node) ){
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_RED );
+                fix_node = parent_node;
+                depth--;
+                continue;
+            }
+            if( !hyrbtree_compact_is_red(sibling_node->right_node) ){
+                hyrbtree_compact_set_color( sibling_node->left_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_RED );
+                sibling_node = hyrbtree_compact_rotate_right( sibling_node );
+                parent_node->right_node = sibling_node;
+            }
+            hyrbtree_compact_set_color( sibling_node,HYRBTREE_READ_NODE_COLOR(parent_node) );
+            hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_compact_set_color( sibling_node->right_node,HYRBTREE_NODE_BLACK );
+            *hyrbtree_compact_link( tree,path,dir,depth ) = hyrbtree_compact_rotate_left( parent_node );
+        }
+        else{
+            sibling_node = parent_node->left_node;
+            if( hyrbtree_compact_is_red(sibling_node) ){
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_RED );
+                *hyrbtree_compact_link( tree,path,dir,depth ) = hyrbtree_compact_rotate_right( parent_node );
+                path[depth] = sibling_node;
+                dir[depth] = 1;
+                depth++;
+                path[depth] = parent_node;
+                dir[depth] = 1;
+                sibling_node = parent_node->left_node;
+            }
+            if( !hyrbtree_compact_is_red(sibling_node->left_node) && !hyrbtree_compact_is_red(sibling_node->right_node) ){
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_RED );
+                fix_node = parent_node;
+                depth--;
+                continue;
+            }
+            if( !hyrbtree_compact_is_red(sibling_node->left_node) ){
+                hyrbtree_compact_set_color( sibling_node->right_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_compact_set_color( sibling_node,HYRBTREE_NODE_RED );
+                sibling_node = hyrbtree_compact_rotate_left( sibling_node );
+                parent_node->left_node = sibling_node;
+            }
+            hyrbtree_compact_set_color( sibling_node,HYRBTREE_READ_NODE_COLOR(parent_node) );
+            hyrbtree_compact_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_compact_set_color( sibling_node->left_node,HYRBTREE_NODE_BLACK );
+            *hyrbtree_compact_link( tree,path,dir,depth ) = hyrbtree_compact_rotate_right( parent_node );
+        }
+        return;
+    }
+    if( fix_node!=HY_NULL ){
+        hyrbtree_compact_set_color( fix_node,HYRBTREE_NODE_BLACK );
+    }
+}
+
+/**
+ * @brief Descend to the leftmost or rightmost node below the cursor top
+ * @param cursor Cursor, path_node[depth-1] is the subtree root
+ * @param right Non-zero for the rightmost node
+ * @return Container of the reached node
+ */
+static void *hyrbtree_compact_cursor_descend( hyrbtree_compact_cursor_t *cursor,hy_u8_t right ){
+    hyrbcnode_t *node;
+
+    node = cursor->path_node[ cursor->depth-1 ];
+    while( 1 ){
+        node = right!=0 ? node->right_node : node->left_node;
+        if( node==HY_NULL ){
+            break;
+        }
+        cursor->path_node[ cursor->depth++ ] = node;
+    }
+    return HYRBTREE_GET_NODE_ADDR( cursor->path_node[ cursor->depth-1 ] );
+}
+
+/**
+ * @brief Step the cursor to the in-order neighbour
+ * @param cursor Positioned cursor
+ * @param right Non-zero for the successor, 0 for the predecessor
+ * @return Neighbour container, HY_NULL past the end
+ */
+static void *hyrbtree_compact_cursor_step( hyrbtree_compact_cursor_t *cursor,hy_u8_t right ){
+    hyrbcnode_t *node;
+    hyrbcnode_t *child_node;
+
+    if( cursor->depth==0 ){
+        return HY_NULL;
+    }
+    node = cursor->path_node[ cursor->depth-1 ];
+    child_node = right!=0 ? node->right_node : node->left_node;
+    if( child_node!=HY_NULL ){
+        cursor->path_node[ cursor->depth++ ] = child_node;
+        return hyrbtree_compact_cursor_descend( cursor,right==0 );
+    }
+
+    /* Climb while coming up from the side we are stepping towards */
+    while( --cursor->depth!=0 ){
+        child_node = node;
+        node = cursor->path_node[ cursor->depth-1 ];
+        if( (right!=0 ? node->left_node : node->right_node)==child_node ){
+            return HYRBTREE_GET_NODE_ADDR( node );
+        }
+    }
+    return HY_NULL;
+}
+
+
+
+/**
+ * @brief Initialize a compact tree
+ * @param tree Compact tree (callbacks/offsets set)
+ */
+void hyrbtree_compact_init( hyrbtree_compact_t *tree ){
+    tree->node_count = 0;
+    tree->root_node = HY_NULL;
+}
+
+/**
+ * @brief Insert a node
+ * @param tree Compact tree
+ * @param user_node Container with an unlinked hyrbcnode_t (user_node HY_NULL)
+ * @param exist_node [out] Returns existing node if key exists
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_ADD_NODE_ELEM_EXIST: Key collision
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: Node already linked
+ */
+hyrbtree_ret_t hyrbtree_compact_add_node( hyrbtree_compact_t *tree,void *user_node,void **exist_node ){
+    hyrbcnode_t *path[HYRBTREE_COMPACT_MAX_DEPTH+1];
+    hy_u8_t dir[HYRBTREE_COMPACT_MAX_DEPTH+1];
+    hyrbcnode_t **link;
+    hyrbcnode_t *node;
+    hyrbcnode_t *add_node;
+    hy_i32_t depth;
+    hy_i32_t cmp_ret;
+    void *elem;
+
+    add_node = hyrbtree_compact_user_to_node( tree,user_node );
+    if( add_node->user_node!=HY_NULL ){
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    }
+    elem = hyrbtree_compact_user_to_elem( tree,user_node );
+
+    link = &tree->root_node;
+    depth = 0;
+    while( *link!=HY_NULL ){
+        node = *link;
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_compact_node_to_elem(tree,node) );
+        if( cmp_ret==0 ){
+            *exist_node = HYRBTREE_GET_NODE_ADDR(node);
+            return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
+        }
+        path[depth] = node;
+        dir[depth] = cmp_ret<0 ? 0 : 1;
+        link = dir[depth]==0 ? &node->left_node : &node->right_node;
+        depth++;
+    }
+
+    add_node->user_node = user_node;
+    add_node->left_node = HY_NULL;
+    add_node->right_node = HY_NULL;
+    *link = add_node;
+    path[depth] = add_node;
+    tree->node_count++;
+
+    hyrbtree_compact_add_balance( tree,path,dir,depth );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Delete a node
+ * @param tree Compact tree
+ * @param user_node Linked container to remove
+ * @return Operation status code
+ *
+ * Descends by key to rebuild the path. A node with two children trades
+ * places (and colors) with its successor before being spliced out.
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_DEL_NODE_ARGS_ERROR: Node not linked in this tree
+ */
+hyrbtree_ret_t hyrbtree_compact_del_node( hyrbtree_compact_t *tree,void *user_node ){
+    hyrbcnode_t *path[HYRBTREE_COMPACT_MAX_DEPTH+1];
+    hy_u8_t dir[HYRBTREE_COMPACT_MAX_DEPTH+1];
+    hyrbcnode_t *del_node;
+    hyrbcnode_t *node;
+    hyrbcnode_t *succ_node;
+    hy_i32_t del_depth;
+    hy_i32_t depth;
+    hy_i32_t cmp_ret;
+    hy_uptr_t color;
+    void *elem;
+
+    del_node = hyrbtree_compact_user_to_node( tree,user_node );
+    if( HYRBTREE_GET_NODE_ADDR(del_node)!=user_node ){
+        return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
+    }
+    elem = hyrbtree_compact_user_to_elem( tree,user_node );
+
+    node = tree->root_node;
+    depth = 0;
+    while( node!=HY_NULL && node!=del_node ){
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_compact_node_to_elem(tree,node) );
+        if( cmp_ret==0 ){
+            break;
+        }
+        path[depth] = node;
+        dir[depth] = cmp_ret<0 ? 0 : 1;
+        node = dir[depth]==0 ? node->left_node : node->right_node;
+        depth++;
+    }
+    if( node!=del_node ){
+        return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
+    }
+    path[depth] = del_node;
+
+    if( del_node->left_node!=HY_NULL && del_node->right_node!=HY_NULL ){
+        /* Extend the path to the successor, then swap the two positions */
+        del_depth = depth;
+        dir[depth++] = 1;
+        succ_node = del_node->right_node;
+        while( succ_node->left_node!=HY_NULL ){
+            path[depth] = succ_node;
+            dir[depth++] = 0;
+            succ_node = succ_node->left_node;
+        }
+
+        *hyrbtree_compact_link( tree,path,dir,del_depth ) = succ_node;
+        succ_node->left_node = del_node->left_node;
+        del_node->left_node = HY_NULL;
+        node = succ_node->right_node;
+        if( depth==del_depth+1 ){
+            succ_node->right_node = del_node;
+        }
+        else{
+            succ_node->right_node = del_node->right_node;
+            path[depth-1]->left_node = del_node;
+        }
+        del_node->right_node = node;
+
+        color = HYRBTREE_READ_NODE_COLOR(succ_node);
+        hyrbtree_compact_set_color( succ_node,HYRBTREE_READ_NODE_COLOR(del_node) );
+        hyrbtree_compact_set_color( del_node,color );
+        path[del_depth] = succ_node;
+        path[depth] = del_node;
+    }
+
+    /* del_node now has at most one child: splice it out */
+    *hyrbtree_compact_link( tree,path,dir,depth ) =
+        del_node->left_node!=HY_NULL ? del_node->left_node : del_node->right_node;
+    color = HYRBTREE_READ_NODE_COLOR(del_node);
+    del_node->user_node = HY_NULL;
+    del_node->left_node = HY_NULL;
+    del_node->right_node = HY_NULL;
+    tree->node_count--;
+
+    if( color==HYRBTREE_NODE_BLACK ){
+        hyrbtree_compact_del_balance( tree,path,dir,depth-1 );
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Find a node by key
+ * @param tree Compact tree
+ * @param elem Key to search
+ * @param get_node [out] Found container
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Key not present
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_compact_get_node( hyrbtree_compact_t *tree,void *elem,void **get_node ){
+    hyrbcnode_t *node;
+    hy_i32_t cmp_ret;
+
+    node = tree->root_node;
+    if( node==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    while( node!=HY_NULL ){
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_compact_node_to_elem(tree,node) );
+        if( cmp_ret==0 ){
+            *get_node = HYRBTREE_GET_NODE_ADDR(node);
+            return HYRBTREE_RET_OK;
+        }
+        node = cmp_ret<0 ? node->left_node : node->right_node;
+    }
+    return HYRBTREE_RET_GET_NODE_NOT_FIND;
+}
+
+/**
+ * @brief Position a cursor on the smallest key
+ * @param tree Compact tree
+ * @param cursor [out] Cursor
+ * @return First container, HY_NULL if empty
+ */
+void *hyrbtree_compact_first( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor ){
+    cursor->tree = tree;
+    cursor->depth = 0;
+    if( tree->root_node==HY_NULL ){
+        return HY_NULL;
+    }
+    cursor->path_node[ cursor->depth++ ] = tree->root_node;
+    return hyrbtree_compact_cursor_descend( cursor,0 );
+}
+
+/**
+ * @brief Position a cursor on the largest key
+ * @param tree Compact tree
+ * @param cursor [out] Cursor
+ * @return Last container, HY_NULL if empty
+ */
+void *hyrbtree_compact_last( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor ){
+    cursor->tree = tree;
+    cursor->depth = 0;
+    if( tree->root_node==HY_NULL ){
+        return HY_NULL;
+    }
+    cursor->path_node[ cursor->depth++ ] = tree->root_node;
+    return hyrbtree_compact_cursor_descend( cursor,1 );
+}
+
+/**
+ * @brief Position a cursor on the first key not less than elem
+ * @param tree Compact tree
+ * @param cursor [out] Cursor
+ * @param elem Key to search
+ * @return Found container, HY_NULL if every key is smaller
+ */
+void *hyrbtree_compact_seek( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor,void *elem ){
+    hyrbcnode_t *node;
+    hy_u32_t found_depth;
+    hy_i32_t cmp_ret;
+
+    cursor->tree = tree;
+    cursor->depth = 0;
+    found_depth = 0;
+    for( node=tree->root_node;node!=HY_NULL; ){
+        cursor->path_node[ cursor->depth++ ] = node;
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_compact_node_to_elem(tree,node) );
+        if( cmp_ret==0 ){
+            return HYRBTREE_GET_NODE_ADDR(node);
+        }
+        if( cmp_ret<0 ){
+            found_depth = cursor->depth;
+            node = node->left_node;
+        }
+        else{
+            node = node->right_node;
+        }
+    }
+
+    /* Trim the path back to the last node we went left at */
+    cursor->depth = found_depth;
+    if( found_depth==0 ){
+        return HY_NULL;
+    }
+    return HYRBTREE_GET_NODE_ADDR( cursor->path_node[ found_depth-1 ] );
+}
+
+/**
+ * @brief Advance a cursor to the next key
+ * @param cursor Positioned cursor
+ * @return Next container, HY_NULL past the last key
+ */
+void *hyrbtree_compact_next( hyrbtree_compact_cursor_t *cursor ){
+    return hyrbtree_compact_cursor_step( cursor,1 );
+}
+
+/**
+ * @brief Move a cursor to the previous key
+ * @param cursor Positioned cursor
+ * @return Previous container, HY_NULL before the first key
+ */
+void *hyrbtree_compact_prev( hyrbtree_compact_cursor_t *cursor ){
+    return hyrbtree_compact_cursor_step( cursor,0 );
+}
@@ -0,0 +1,93 @@
+/**
+ * @file hyrbtree_compact.h
+ * @brief Parent-Free Compact Red-Black Tree
+ *
+ * Alternative intrusive layout for very large trees:
+ * - Three-word hyrbcnode_t (24 bytes on 64-bit), no parent pointer
+ * - Color bit kept in user_node as in hyrbnode_t
+ * - Insert/delete rebalance along a bounded path stack
+ * - Iteration through a cursor that carries its own ancestor stack
+ *
+ * Keys must be unique. Registration works as for hyrbtree_t (callbacks or
+ * HYRBTREE_OFFSET_INIT with a hyrbcnode_t member).
+ */
+
+#ifndef HYRBTREE_COMPACT_H
+#define HYRBTREE_COMPACT_H
+
+#include "hyrbtree.h"
+
+
+
+/* Path stack depth (red-black height is at most 2*log2(n+1) <= 64 for 32-bit counts) */
+#define HYRBTREE_COMPACT_MAX_DEPTH      64
+
+
+
+/**
+ * @brief Compact tree node, embed in user structures
+ */
+typedef struct hyrbcnode_t{
+    void *user_node;                    ///< Container address, bit 0 holds the color
+    struct hyrbcnode_t *left_node;      ///< Left child, HY_NULL for none
+    struct hyrbcnode_t *right_node;     ///< Right child, HY_NULL for none
+}hyrbcnode_t;
+
+/**
+ * @brief Compact tree
+ */
+typedef struct{
+    /**
+     * @brief Callback to get the embedded node
+     * @param user_node Container structure
+     * @return Embedded hyrbcnode_t, HY_NULL to use rbnode_offset
+     */
+    hyrbcnode_t* (*get_rbnode)(void *user_node);
+
+    /**
+     * @brief Callback to get the comparison key
+     * @param user_node Container structure
+     * @return Pointer to comparable key, HY_NULL to use elem_offset
+     */
+    void* (*get_elem)(void *user_node);
+
+    /**
+     * @brief Element comparison callback (see hyrbtree_t)
+     */
+    hy_i32_t (*cmp_elem)(void *elem1,void *elem2);
+
+    hy_u32_t rbnode_offset;     ///< Node offset inside the container (get_rbnode==HY_NULL)
+    hy_u32_t elem_offset;       ///< Key offset inside the container (get_elem==HY_NULL)
+
+    hy_u32_t node_count;        ///< Linked nodes
+    hyrbcnode_t *root_node;     ///< Root, HY_NULL when empty
+}hyrbtree_compact_t;
+
+/**
+ * @brief In-order cursor
+ *
+ * Holds the path from the root to the current node. Any insert or delete
+ * invalidates every cursor on the tree.
+ */
+typedef struct{
+    hyrbtree_compact_t *tree;                           ///< Tree being walked
+    hyrbcnode_t *path_node[HYRBTREE_COMPACT_MAX_DEPTH]; ///< Root to current node
+    hy_u32_t depth;                                     ///< Path length, 0 when past either end
+}hyrbtree_compact_cursor_t;
+
+
+
+/* Compact Tree API */
+void hyrbtree_compact_init( hyrbtree_compact_t *tree );
+hyrbtree_ret_t hyrbtree_compact_add_node( hyrbtree_compact_t *tree,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_compact_del_node( hyrbtree_compact_t *tree,void *user_node );
+hyrbtree_ret_t hyrbtree_compact_get_node( hyrbtree_compact_t *tree,void *elem,void **get_node );
+
+/* Cursor Iteration */
+void *hyrbtree_compact_first( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor );
+void *hyrbtree_compact_last( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor );
+void *hyrbtree_compact_seek( hyrbtree_compact_t *tree,hyrbtree_compact_cursor_t *cursor,void *elem );
+void *hyrbtree_compact_next( hyrbtree_compact_cursor_t *cursor );
+void *hyrbtree_compact_prev( hyrbtree_compact_cursor_t *cursor );
+
+#endif
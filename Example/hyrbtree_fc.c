@@ -0,0 +1,255 @@
+/**
+ * @file hyrbtree_fc.c
+ * @brief Flat-Combining Writer Front End Implementation
+ */
+
+#include "hyrbtree_fc.h"
+
+
+
+/**
+ * @brief Locate the embedded rbnode of a container
+ * @param tree Tree structure
+ * @param user_node Container structure
+ * @return Embedded rbnode
+ */
+static inline hyrbnode_t *hyrbtree_fc_user_to_rbnode( hyrbtree_t *tree,void *user_node ){
+    if( tree->get_rbnode!=HY_NULL ){
+        return tree->get_rbnode(user_node);
+    }
+    return (hyrbnode_t *)((hy_u8_t *)user_node+tree->rbnode_offset);
+}
+
+/**
+ * @brief Locate the key a request is ordered by
+ * @param tree Tree structure
+ * @param slot Pending request
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_fc_slot_elem( hyrbtree_t *tree,hyrbtree_fc_slot_t *slot ){
+    void *user_node;
+
+    user_node = slot->op==HYRBTREE_FC_OP_REPLACE ? slot->old_node : slot->user_node;
+    if( tree->get_elem!=HY_NULL ){
+        return tree->get_elem(user_node);
+    }
+    return (void *)((hy_u8_t *)user_node+tree->elem_offset);
+}
+
+/**
+ * @brief Sort pending requests by key
+ * @param tree Tree structure
+ * @param batch Pending requests
+ * @param batch_num Request count (<= HYRBTREE_CFG_FC_SLOTS)
+ *
+ * Insertion sort: batches are small and often nearly ordered.
+ */
+static void hyrbtree_fc_sort( hyrbtree_t *tree,hyrbtree_fc_slot_t **batch,hy_u32_t batch_num ){
+    hyrbtree_fc_slot_t *slot;
+    void *elem;
+    hy_u32_t i;
+    hy_u32_t j;
+
+    for( i=1;i<batch_num;i++ ){
+        slot = batch[i];
+        elem = hyrbtree_fc_slot_elem(tree,slot);
+        for( j=i;j>0 && tree->cmp_elem( hyrbtree_fc_slot_elem(tree,batch[j-1]),elem )>0;j-- ){
+            batch[j] = batch[j-1];
+        }
+        batch[j] = slot;
+    }
+}
+
+/**
+ * @brief Apply one request
+ * @param tree Tree structure (write section held)
+ * @param slot Pending request
+ * @param hint Linked node near the key, HY_NULL for none
+ * @return Linked node near the next key, for the following request
+ */
+static void *hyrbtree_fc_apply( hyrbtree_t *tree,hyrbtree_fc_slot_t *slot,void *hint ){
+    void *near_node;
+
+    switch( slot->op ){
+        case HYRBTREE_FC_OP_ADD:
+            slot->ret = hyrbtree_add_node_hint( tree,hint,slot->user_node,&slot->exist_node );
+            if( slot->ret==HYRBTREE_RET_OK ){
+                hint = slot->user_node;
+            }
+            else if( slot->ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                hint = slot->exist_node;
+            }
+            break;
+
+        case HYRBTREE_FC_OP_DEL:
+            near_node = hint;
+            if( HYRBTREE_GET_NODE_ADDR( hyrbtree_fc_user_to_rbnode(tree,slot->user_node) )==slot->user_node ){
+                near_node = hyrbtree_next(tree,slot->user_node);
+                if( near_node==HY_NULL ){
+                    near_node = hyrbtree_prev(tree,slot->user_node);
+                }
+            }
+            slot->ret = hyrbtree_del_node( tree,slot->user_node );
+            if( slot->ret==HYRBTREE_RET_OK ){
+                hint = near_node;
+            }
+            break;
+
+        case HYRBTREE_FC_OP_REPLACE:
+            slot->ret = hyrbtree_replace_node( tree,slot->old_node,slot->user_node );
+            if( slot->ret==HYRBTREE_RET_OK ){
+                hint = slot->user_node;
+            }
+            break;
+
+        default:
+            slot->ret = HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
+            break;
+    }
+    return hint;
+}
+
+/**
+ * @brief Serve every pending request
+ * @param fc Flat-combining tree (write section held)
+ *
+ * Each pass collects the pending slots, sorts them by key and applies
+ * them with each request's successor hinted by its predecessor, so runs
+ * of nearby keys skip most of the descent.
+ */
+static void hyrbtree_fc_combine( hyrbtree_fc_t *fc ){
+    hyrbtree_t *tree;
+    hyrbtree_fc_slot_t *batch[HYRBTREE_CFG_FC_SLOTS];
+    hy_u32_t batch_num;
+    hy_u32_t pass;
+    hy_u32_t i;
+    void *hint;
+
+    tree = &fc->sync.tree;
+    for( pass=0;pass<HYRBTREE_CFG_FC_PASSES;pass++ ){
+        batch_num = 0;
+        for( i=0;i<fc->slot_num;i++ ){
+            if( __atomic_load_n(&fc->slots[i].state,__ATOMIC_ACQUIRE)==HYRBTREE_FC_SLOT_PENDING ){
+                batch[ batch_num++ ] = &fc->slots[i];
+            }
+        }
+        if( batch_num==0 ){
+            break;
+        }
+
+        hyrbtree_fc_sort( tree,batch,batch_num );
+        hint = HY_NULL;
+        for( i=0;i<batch_num;i++ ){
+            hint = hyrbtree_fc_apply( tree,batch[i],hint );
+            __atomic_store_n(&batch[i]->state,HYRBTREE_FC_SLOT_DONE,__ATOMIC_RELEASE);
+        }
+    }
+}
+
+/**
+ * @brief Publish a filled slot and wait for its result
+ * @param fc Flat-combining tree
+ * @param slot Caller's slot (request fields set)
+ * @return Result published by the combiner
+ *
+ * Becomes the combiner whenever the writer lock is free.
+ */
+static hyrbtree_ret_t hyrbtree_fc_submit( hyrbtree_fc_t *fc,hyrbtree_fc_slot_t *slot ){
+    __atomic_store_n(&slot->state,HYRBTREE_FC_SLOT_PENDING,__ATOMIC_RELEASE);
+    while( __atomic_load_n(&slot->state,__ATOMIC_ACQUIRE)!=HYRBTREE_FC_SLOT_DONE ){
+        if( hyrbtree_sync_try_write_lock( &fc->sync )!=0 ){
+            hyrbtree_fc_combine( fc );
+            hyrbtree_sync_write_unlock( &fc->sync );
+        }
+        else{
+            HY_CPU_RELAX();
+        }
+    }
+    slot->state = HYRBTREE_FC_SLOT_IDLE;
+    return slot->ret;
+}
+
+
+
+/**
+ * @brief Initialize a flat-combining tree
+ * @param fc Flat-combining tree (tree callbacks, slots and slot_num set)
+ */
+void hyrbtree_fc_init( hyrbtree_fc_t *fc ){
+    hy_u32_t i;
+
+    if( fc->slot_num>HYRBTREE_CFG_FC_SLOTS ){
+        fc->slot_num = HYRBTREE_CFG_FC_SLOTS;
+    }
+    for( i=0;i<fc->slot_num;i++ ){
+        fc->slots[i].state = HYRBTREE_FC_SLOT_IDLE;
+    }
+    hyrbtree_sync_init( &fc->sync );
+}
+
+/**
+ * @brief Insert a node through the combiner
+ * @param fc Flat-combining tree
+ * @param slot Caller's slot index
+ * @param user_node User data containing embedded rbnode
+ * @param exist_node [out] Returns existing node if key exists
+ * @return Operation status code (see hyrbtree_add_node)
+ */
+hyrbtree_ret_t hyrbtree_fc_add_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *user_node,void **exist_node ){
+    hyrbtree_fc_slot_t *slot_ptr;
+    hyrbtree_ret_t ret;
+
+    slot_ptr = &fc->slots[slot];
+    slot_ptr->op = HYRBTREE_FC_OP_ADD;
+    slot_ptr->user_node = user_node;
+    ret = hyrbtree_fc_submit( fc,slot_ptr );
+    if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+        *exist_node = slot_ptr->exist_node;
+    }
+    return ret;
+}
+
+/**
+ * @brief Remove a node through the combiner
+ * @param fc Flat-combining tree
+ * @param slot Caller's slot index
+ * @param user_node Node to delete
+ * @return Operation status code (see hyrbtree_del_node)
+ */
+hyrbtree_ret_t hyrbtree_fc_del_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *user_node ){
+    hyrbtree_fc_slot_t *slot_ptr;
+
+    slot_ptr = &fc->slots[slot];
+    slot_ptr->op = HYRBTREE_FC_OP_DEL;
+    slot_ptr->user_node = user_node;
+    return hyrbtree_fc_submit( fc,slot_ptr );
+}
+
+/**
+ * @brief Replace a node through the combiner
+ * @param fc Flat-combining tree
+ * @param slot Caller's slot index
+ * @param old_node Linked node
+ * @param new_node Detached node with an equal key
+ * @return Operation status code (see hyrbtree_replace_node)
+ */
+hyrbtree_ret_t hyrbtree_fc_replace_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *old_node,void *new_node ){
+    hyrbtree_fc_slot_t *slot_ptr;
+
+    slot_ptr = &fc->slots[slot];
+    slot_ptr->op = HYRBTREE_FC_OP_REPLACE;
+    slot_ptr->old_node = old_node;
+    slot_ptr->user_node = new_node;
+    return hyrbtree_fc_submit( fc,slot_ptr );
+}
+
+/**
+ * @brief Find a node without taking the lock
+ * @param fc Flat-combining tree
+ * @param get_elem Key to search
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_sync_get_node)
+ */
+hyrbtree_ret_t hyrbtree_fc_get_node( hyrbtree_fc_t *fc,void *get_elem,void **get_node ){
+    return hyrbtree_sync_get_node( &fc->sync,get_elem,get_node );
+}
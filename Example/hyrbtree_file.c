@@ -0,0 +1,351 @@
+/**
+ * @file hyrbtree_file.c
+ * @brief Memory-Mapped Persistent Tree File Implementation
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "hyrbtree_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+
+/**
+ * @brief Header checksum (FNV-1a over the fields before checksum)
+ * @param header Mapped header
+ * @return Checksum value
+ */
+static hy_u32_t hyrbtree_file_checksum( hyrbtree_file_header_t *header ){
+    hy_u8_t *byte;
+    hy_u32_t hash;
+    hy_u32_t i;
+
+    byte = (hy_u8_t *)header;
+    hash = 2166136261u;
+    for( i=0;i<offsetof(hyrbtree_file_header_t,checksum);i++ ){
+        hash = (hash^byte[i])*16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Locate the node of a record index
+ * @param file Open tree file
+ * @param idx Record index
+ * @return Embedded node
+ */
+static inline hyrbinode_t *hyrbtree_file_node( hyrbtree_file_t *file,hy_u32_t idx ){
+    return (hyrbinode_t *)((hy_u8_t *)HYRBTREE_IDX_TO_USER(&file->tree,idx)+file->tree.rbnode_offset);
+}
+
+/**
+ * @brief Convert a mapped record address to its index
+ * @param file Open tree file
+ * @param record Record inside the mapping
+ * @return Record index
+ */
+static inline hy_u32_t hyrbtree_file_record_idx( hyrbtree_file_t *file,void *record ){
+    return (hy_u32_t)(((hy_u8_t *)record-(hy_u8_t *)file->tree.node_base)/file->tree.node_stride);
+}
+
+/**
+ * @brief Mark the file modified since its last sync
+ * @param file Open tree file
+ * @return Operation status code
+ *
+ * The dirty flag reaches the disk before any record changes, so a file
+ * torn by a crash or power loss is refused on open.
+ * Returns:
+ * - HYRBTREE_RET_OK: Flag set
+ * - HYRBTREE_RET_FILE_IO_ERROR: msync failed, nothing may be modified
+ */
+static hyrbtree_ret_t hyrbtree_file_touch( hyrbtree_file_t *file ){
+    if( file->header->dirty==0 ){
+        file->header->dirty = 1;
+        if( msync( file->map_addr,HYRBTREE_FILE_HEADER_SIZE,MS_SYNC )!=0 ){
+            file->header->dirty = 0;
+            return HYRBTREE_RET_FILE_IO_ERROR;
+        }
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Check a mapped header against the caller's record layout
+ * @param file Tree file (tree layout fields set)
+ * @return Non-zero if the header is usable
+ */
+static hy_u8_t hyrbtree_file_header_valid( hyrbtree_file_t *file ){
+    hyrbtree_file_header_t *header;
+
+    header = file->header;
+    return header->magic==HYRBTREE_FILE_MAGIC &&
+           header->version==HYRBTREE_FILE_VERSION &&
+           header->checksum==hyrbtree_file_checksum(header) &&
+           header->dirty==0 &&
+           header->node_stride==file->tree.node_stride &&
+           header->rbnode_offset==file->tree.rbnode_offset &&
+           header->elem_offset==file->tree.elem_offset &&
+           header->node_num<HYRBTREE_IDX_NIL &&
+           header->used_num<=header->node_num &&
+           HYRBTREE_FILE_HEADER_SIZE+(hy_u64_t)header->node_num*header->node_stride<=file->map_size;
+}
+
+
+
+/**
+ * @brief Open or create a tree file
+ * @param file Tree file (layout fields and cmp_elem set)
+ * @param path File path
+ * @param node_num Record capacity when creating, ignored for existing files
+ * @return Operation status code
+ *
+ * An existing file is mapped and trusted after its header checks out, no
+ * record is read.
+ * Returns:
+ * - HYRBTREE_RET_OK: File open
+ * - HYRBTREE_RET_FILE_IO_ERROR: open/stat/truncate/mmap failed
+ * - HYRBTREE_RET_FILE_FORMAT_ERROR: Bad header, other record layout, file
+ *   not synced after its last change, or bad node_num on create
+ */
+hyrbtree_ret_t hyrbtree_file_open( hyrbtree_file_t *file,const char *path,hy_u32_t node_num ){
+    hyrbtree_file_header_t *header;
+    struct stat file_stat;
+    hy_u8_t create;
+
+    file->fd = open( path,O_RDWR|O_CREAT,0644 );
+    if( file->fd<0 ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    if( fstat( file->fd,&file_stat )!=0 ){
+        close( file->fd );
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+
+    create = file_stat.st_size==0;
+    if( create!=0 ){
+        if( node_num==0 || node_num>=HYRBTREE_IDX_NIL ){
+            close( file->fd );
+            return HYRBTREE_RET_FILE_FORMAT_ERROR;
+        }
+        file->map_size = HYRBTREE_FILE_HEADER_SIZE+(hy_uptr_t)node_num*file->tree.node_stride;
+        if( ftruncate( file->fd,(off_t)file->map_size )!=0 ){
+            close( file->fd );
+            return HYRBTREE_RET_FILE_IO_ERROR;
+        }
+    }
+    else{
+        if( (hy_u64_t)file_stat.st_size<HYRBTREE_FILE_HEADER_SIZE ){
+            close( file->fd );
+            return HYRBTREE_RET_FILE_FORMAT_ERROR;
+        }
+        file->map_size = (hy_uptr_t)file_stat.st_size;
+    }
+
+    file->map_addr = mmap( HY_NULL,file->map_size,PROT_READ|PROT_WRITE,MAP_SHARED,file->fd,0 );
+    if( file->map_addr==MAP_FAILED ){
+        close( file->fd );
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    header = (hyrbtree_file_header_t *)file->map_addr;
+    file->header = header;
+
+    if( create!=0 ){
+        header->magic = HYRBTREE_FILE_MAGIC;
+        header->version = HYRBTREE_FILE_VERSION;
+        header->node_stride = file->tree.node_stride;
+        header->rbnode_offset = file->tree.rbnode_offset;
+        header->elem_offset = file->tree.elem_offset;
+        header->node_num = node_num;
+        header->node_count = 0;
+        header->root_idx = HYRBTREE_IDX_NIL;
+        header->free_idx = HYRBTREE_IDX_NIL;
+        header->used_num = 0;
+        header->dirty = 0;
+        header->checksum = hyrbtree_file_checksum( header );
+    }
+    else if( hyrbtree_file_header_valid(file)==0 ){
+        munmap( file->map_addr,file->map_size );
+        close( file->fd );
+        return HYRBTREE_RET_FILE_FORMAT_ERROR;
+    }
+
+    file->tree.node_base = (hy_u8_t *)file->map_addr+HYRBTREE_FILE_HEADER_SIZE;
+    file->tree.node_num = header->node_num;
+    file->tree.node_count = header->node_count;
+    file->tree.root_idx = header->root_idx;
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Write the header and flush the mapping
+ * @param file Open tree file
+ * @return Operation status code
+ *
+ * Records are flushed while the header still reads dirty; only then is the
+ * clean header written and flushed on its own.
+ * Returns:
+ * - HYRBTREE_RET_OK: File consistent on disk
+ * - HYRBTREE_RET_FILE_IO_ERROR: msync failed
+ */
+hyrbtree_ret_t hyrbtree_file_sync( hyrbtree_file_t *file ){
+    hyrbtree_file_header_t *header;
+
+    header = file->header;
+    header->node_count = file->tree.node_count;
+    header->root_idx = file->tree.root_idx;
+    if( msync( file->map_addr,file->map_size,MS_SYNC )!=0 ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    header->dirty = 0;
+    header->checksum = hyrbtree_file_checksum( header );
+    if( msync( file->map_addr,HYRBTREE_FILE_HEADER_SIZE,MS_SYNC )!=0 ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Sync and unmap a tree file
+ * @param file Open tree file
+ * @return Operation status code (see hyrbtree_file_sync)
+ */
+hyrbtree_ret_t hyrbtree_file_close( hyrbtree_file_t *file ){
+    hyrbtree_ret_t ret;
+
+    ret = hyrbtree_file_sync( file );
+    munmap( file->map_addr,file->map_size );
+    close( file->fd );
+    file->map_addr = HY_NULL;
+    file->header = HY_NULL;
+    return ret;
+}
+
+/**
+ * @brief Take an unused record
+ * @param file Open tree file
+ * @param record [out] Record in the mapping (node unlinked, key unset)
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Record taken
+ * - HYRBTREE_RET_FILE_FULL: Capacity reached
+ * - HYRBTREE_RET_FILE_IO_ERROR: Dirty flag could not be flushed
+ */
+hyrbtree_ret_t hyrbtree_file_new_record( hyrbtree_file_t *file,void **record ){
+    hyrbtree_file_header_t *header;
+    hy_u32_t idx;
+
+    header = file->header;
+    if( header->free_idx==HYRBTREE_IDX_NIL && header->used_num>=header->node_num ){
+        return HYRBTREE_RET_FILE_FULL;
+    }
+    if( hyrbtree_file_touch( file )!=HYRBTREE_RET_OK ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    if( header->free_idx!=HYRBTREE_IDX_NIL ){
+        idx = header->free_idx;
+        header->free_idx = hyrbtree_file_node(file,idx)->right_idx;
+    }
+    else{
+        idx = header->used_num++;
+    }
+    hyrbtree_file_node(file,idx)->left_idx = HYRBTREE_IDX_UNLINKED;
+    *record = HYRBTREE_IDX_TO_USER( &file->tree,idx );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Return an unlinked record
+ * @param file Open tree file
+ * @param record Record from hyrbtree_file_new_record, not in the tree
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Record freed
+ * - HYRBTREE_RET_FILE_IO_ERROR: Dirty flag could not be flushed
+ */
+hyrbtree_ret_t hyrbtree_file_free_record( hyrbtree_file_t *file,void *record ){
+    hyrbinode_t *node;
+    hy_u32_t idx;
+
+    if( hyrbtree_file_touch( file )!=HYRBTREE_RET_OK ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    idx = hyrbtree_file_record_idx( file,record );
+    node = hyrbtree_file_node( file,idx );
+    node->left_idx = HYRBTREE_IDX_UNLINKED;
+    node->right_idx = file->header->free_idx;
+    file->header->free_idx = idx;
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Link a record into the tree
+ * @param file Open tree file
+ * @param record Record from hyrbtree_file_new_record with its key set
+ * @param exist_record [out] Returns existing record if key exists
+ * @return Operation status code (see hyrbtree_idx_add_node, or
+ * HYRBTREE_RET_FILE_IO_ERROR if the dirty flag could not be flushed)
+ */
+hyrbtree_ret_t hyrbtree_file_add_node( hyrbtree_file_t *file,void *record,void **exist_record ){
+    hyrbtree_ret_t ret;
+    hy_u32_t exist_idx;
+
+    if( hyrbtree_file_touch( file )!=HYRBTREE_RET_OK ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    ret = hyrbtree_idx_add_node( &file->tree,hyrbtree_file_record_idx(file,record),&exist_idx );
+    if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+        *exist_record = HYRBTREE_IDX_TO_USER( &file->tree,exist_idx );
+    }
+    return ret;
+}
+
+/**
+ * @brief Unlink a record and return it to the free list
+ * @param file Open tree file
+ * @param record Linked record
+ * @return Operation status code (see hyrbtree_idx_del_node, or
+ * HYRBTREE_RET_FILE_IO_ERROR if the dirty flag could not be flushed)
+ */
+hyrbtree_ret_t hyrbtree_file_del_node( hyrbtree_file_t *file,void *record ){
+    hyrbtree_ret_t ret;
+
+    if( hyrbtree_file_touch( file )!=HYRBTREE_RET_OK ){
+        return HYRBTREE_RET_FILE_IO_ERROR;
+    }
+    ret = hyrbtree_idx_del_node( &file->tree,hyrbtree_file_record_idx(file,record) );
+    if( ret==HYRBTREE_RET_OK ){
+        hyrbtree_file_free_record( file,record );
+    }
+    return ret;
+}
+
+/**
+ * @brief Find a record by key
+ * @param file Open tree file
+ * @param elem Key to search
+ * @param get_record [out] Found record
+ * @return Operation status code (see hyrbtree_idx_get_node)
+ */
+hyrbtree_ret_t hyrbtree_file_get_node( hyrbtree_file_t *file,void *elem,void **get_record ){
+    hyrbtree_ret_t ret;
+    hy_u32_t get_idx;
+
+    ret = hyrbtree_idx_get_node( &file->tree,elem,&get_idx );
+    if( ret==HYRBTREE_RET_OK ){
+        *get_record = HYRBTREE_IDX_TO_USER( &file->tree,get_idx );
+    }
+    return ret;
+}
+
+#endif
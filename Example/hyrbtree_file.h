@@ -0,0 +1,89 @@
+/**
+ * @file hyrbtree_file.h
+ * @brief Memory-Mapped Persistent Tree File
+ *
+ * Stores an index-addressed tree (hyrbtree_idx_t) together with its
+ * records in one mmap'ed file:
+ * - Records, links and keys live in the mapping; links are array indices,
+ *   so the file is valid at any mapping address
+ * - Reopening is O(1): map the file and check the header (magic, version,
+ *   record layout, checksum)
+ * - The header is rewritten by hyrbtree_file_sync/close; a file modified
+ *   after its last sync is refused on open, even after a power loss: the
+ *   dirty flag is flushed before the first change, and cleared only once
+ *   the records are on disk
+ *
+ * Records are fixed-size structures holding a hyrbinode_t and an inline
+ * key (no pointers). Capacity is fixed when the file is created.
+ * Requires POSIX mmap.
+ */
+
+#ifndef HYRBTREE_FILE_H
+#define HYRBTREE_FILE_H
+
+#include "hyrbtree_idx.h"
+
+
+
+/* File identification */
+#define HYRBTREE_FILE_MAGIC             ((hy_u32_t)0x42525948)     /* "HYRB" */
+#define HYRBTREE_FILE_VERSION           1
+
+/* Bytes reserved for the header before the record array */
+#define HYRBTREE_FILE_HEADER_SIZE       64
+
+
+
+/**
+ * @brief On-disk header (first HYRBTREE_FILE_HEADER_SIZE bytes)
+ */
+typedef struct{
+    hy_u32_t magic;             ///< HYRBTREE_FILE_MAGIC
+    hy_u32_t version;           ///< HYRBTREE_FILE_VERSION
+    hy_u32_t node_stride;       ///< Bytes per record
+    hy_u32_t rbnode_offset;     ///< hyrbinode_t offset inside a record
+    hy_u32_t elem_offset;       ///< Key offset inside a record
+    hy_u32_t node_num;          ///< Record capacity
+    hy_u32_t node_count;        ///< Linked records
+    hy_u32_t root_idx;          ///< Root record, HYRBTREE_IDX_NIL when empty
+    hy_u32_t free_idx;          ///< First recycled record, chained through right_idx
+    hy_u32_t used_num;          ///< Records ever handed out (the rest are untouched)
+    hy_u32_t dirty;             ///< Non-zero while modified since the last sync
+    hy_u32_t checksum;          ///< Checksum of the fields above
+}hyrbtree_file_header_t;
+
+/**
+ * @brief Open tree file
+ *
+ * Fill tree.node_stride, tree.rbnode_offset, tree.elem_offset and
+ * tree.cmp_elem, then call hyrbtree_file_open.
+ */
+typedef struct{
+    hyrbtree_idx_t tree;                ///< Tree over the mapped records
+    hyrbtree_file_header_t *header;     ///< Mapped header
+    void *map_addr;                     ///< Mapping base
+    hy_uptr_t map_size;                 ///< Mapping length
+    int fd;                             ///< Backing file descriptor
+}hyrbtree_file_t;
+
+
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/* File Lifecycle */
+hyrbtree_ret_t hyrbtree_file_open( hyrbtree_file_t *file,const char *path,hy_u32_t node_num );
+hyrbtree_ret_t hyrbtree_file_sync( hyrbtree_file_t *file );
+hyrbtree_ret_t hyrbtree_file_close( hyrbtree_file_t *file );
+
+/* Records */
+hyrbtree_ret_t hyrbtree_file_new_record( hyrbtree_file_t *file,void **record );
+hyrbtree_ret_t hyrbtree_file_free_record( hyrbtree_file_t *file,void *record );
+
+/* Tree Operations */
+hyrbtree_ret_t hyrbtree_file_add_node( hyrbtree_file_t *file,void *record,void **exist_record );
+hyrbtree_ret_t hyrbtree_file_del_node( hyrbtree_file_t *file,void *record );
+hyrbtree_ret_t hyrbtree_file_get_node( hyrbtree_file_t *file,void *elem,void **get_record );
+
+#endif
+
+#endif
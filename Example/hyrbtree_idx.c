@@ -0,0 +1,547 @@
+/**
+ * @file hyrbtree_idx.c
+ * @brief Index-Addressed Red-Black Tree Implementation
+ *
+ * There is no sentinel node behind HYRBTREE_IDX_NIL, so deletion tracks
+ * the parent of the fix-up position explicitly instead of storing it in
+ * the sentinel.
+ */
+
+#include "hyrbtree_idx.h"
+
+
+
+/**
+ * @brief Locate the node at an array index
+ * @param tree Index tree
+ * @param idx Array index (not NIL)
+ * @return Embedded node
+ */
+static inline hyrbinode_t *hyrbtree_idx_node( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    return (hyrbinode_t *)((hy_u8_t *)HYRBTREE_IDX_TO_USER(tree,idx)+tree->rbnode_offset);
+}
+
+/**
+ * @brief Locate the key at an array index
+ * @param tree Index tree
+ * @param idx Array index (not NIL)
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_idx_elem( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    return (void *)((hy_u8_t *)HYRBTREE_IDX_TO_USER(tree,idx)+tree->elem_offset);
+}
+
+/**
+ * @brief Read the parent index of a node
+ * @param node Linked node
+ * @return Parent index, HYRBTREE_IDX_NIL for the root
+ */
+static inline hy_u32_t hyrbtree_idx_parent( hyrbinode_t *node ){
+    return node->parent_idx & ~HYRBTREE_IDX_COLOR_BIT;
+}
+
+/**
+ * @brief Set the parent index of a node, keeping its color
+ * @param node Linked node
+ * @param parent_idx New parent index
+ */
+static inline void hyrbtree_idx_set_parent( hyrbinode_t *node,hy_u32_t parent_idx ){
+    node->parent_idx = (node->parent_idx & HYRBTREE_IDX_COLOR_BIT) | parent_idx;
+}
+
+/**
+ * @brief Check node color, NIL counts as black
+ * @param tree Index tree
+ * @param idx Array index or NIL
+ * @return Non-zero if red
+ */
+static inline hy_u8_t hyrbtree_idx_is_red( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    return idx!=HYRBTREE_IDX_NIL && (hyrbtree_idx_node(tree,idx)->parent_idx & HYRBTREE_IDX_COLOR_BIT)==0;
+}
+
+/**
+ * @brief Set node color
+ * @param node Linked node
+ * @param color HYRBTREE_NODE_RED or _BLACK
+ */
+static inline void hyrbtree_idx_set_color( hyrbinode_t *node,hy_u8_t color ){
+    if( color==HYRBTREE_NODE_BLACK ){
+        node->parent_idx |= HYRBTREE_IDX_COLOR_BIT;
+    }
+    else{
+        node->parent_idx &= ~HYRBTREE_IDX_COLOR_BIT;
+    }
+}
+
+/**
+ * @brief Replace a child link of a parent (or the root)
+ * @param tree Index tree
+ * @param parent_idx Parent index, NIL for the root
+ * @param old_idx Current child
+ * @param new_idx Replacement child
+ */
+static inline void hyrbtree_idx_change_child( hyrbtree_idx_t *tree,hy_u32_t parent_idx,
+    hy_u32_t old_idx,hy_u32_t new_idx ){
+
+    hyrbinode_t *parent_node;
+
+    if( parent_idx==HYRBTREE_IDX_NIL ){
+        tree->root_idx = new_idx;
+        return;
+    }
+    parent_node = hyrbtree_idx_node( tree,parent_idx );
+    if( parent_node->left_idx==old_idx ){
+        parent_node->left_idx = new_idx;
+    }
+    else{
+        parent_node->right_idx = new_idx;
+    }
+}
+
+/**
+ * @brief Left rotation around a node
+ * @param tree Index tree
+ * @param idx Rotation pivot (has a right child)
+ */
+static void hyrbtree_idx_left_rotate( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *node;
+    hyrbinode_t *right_node;
+    hy_u32_t right_idx;
+
+    node = hyrbtree_idx_node( tree,idx );
+    right_idx = node->right_idx;
+    right_node = hyrbtree_idx_node( tree,right_idx );
+
+    node->right_idx = right_node->left_idx;
+    if( right_node->left_idx!=HYRBTREE_IDX_NIL ){
+        hyrbtree_idx_set_parent( hyrbtree_idx_node(tree,right_node->left_idx),idx );
+    }
+    hyrbtree_idx_set_parent( right_node,hyrbtree_idx_parent(node) );
+    hyrbtree_idx_change_child( tree,hyrbtree_idx_parent(node),idx,right_idx );
+    right_node->left_idx = idx;
+    hyrbtree_idx_set_parent( node,right_idx );
+}
+
+/**
+ * @brief Right rotation around a node
+ * @param tree Index tree
+ * @param idx Rotation pivot (has a left child)
+ */
+static void hyrbtree_idx_right_rotate( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *node;
+    hyrbinode_t *left_node;
+    hy_u32_t left_idx;
+
+    node = hyrbtree_idx_node( tree,idx );
+    left_idx = node->left_idx;
+    left_node = hyrbtree_idx_node( tree,left_idx );
+
+    node->left_idx = left_node->right_idx;
+    if( left_node->right_idx!=HYRBTREE_IDX_NIL ){
+        hyrbtree_idx_set_parent( hyrbtree_idx_node(tree,left_node->right_idx),idx );
+    }
+    hyrbtree_idx_set_parent( left_node,hyrbtree_idx_parent(node) );
+    hyrbtree_idx_change_child( tree,hyrbtree_idx_parent(node),idx,left_idx );
+    left_node->right_idx = idx;
+    hyrbtree_idx_set_parent( node,left_idx );
+}
+
+/**
+ * @brief Restore balance after linking a red node
+ * @param tree Index tree
+ * @param idx Newly linked node
+ */
+static void hyrbtree_idx_add_balance( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *parent_node;
+    hyrbinode_t *grand_node;
+    hy_u32_t parent_idx;
+    hy_u32_t grand_idx;
+    hy_u32_t uncle_idx;
+
+    while( 1 ){
+        parent_idx = hyrbtree_idx_parent( hyrbtree_idx_node(tree,idx) );
+        if( !hyrbtree_idx_is_red(tree,parent_idx) ){
+            break;
+        }
+        parent_node = hyrbtree_idx_node( tree,parent_idx );
+        grand_idx = hyrbtree_idx_parent( parent_node );
+        grand_node = hyrbtree_idx_node( tree,grand_idx );
+
+        if( grand_node->left_idx==parent_idx ){
+            uncle_idx = grand_node->right_idx;
+            if( hyrbtree_idx_is_red(tree,uncle_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,uncle_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( grand_node,HYRBTREE_NODE_RED );
+                idx = grand_idx;
+                continue;
+            }
+            if( parent_node->right_idx==idx ){
+                hyrbtree_idx_left_rotate( tree,parent_idx );
+                idx = parent_idx;
+                parent_idx = hyrbtree_idx_parent( hyrbtree_idx_node(tree,idx) );
+                parent_node = hyrbtree_idx_node( tree,parent_idx );
+            }
+            hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_set_color( grand_node,HYRBTREE_NODE_RED );
+            hyrbtree_idx_right_rotate( tree,grand_idx );
+        }
+        else{
+            uncle_idx = grand_node->left_idx;
+            if( hyrbtree_idx_is_red(tree,uncle_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,uncle_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( grand_node,HYRBTREE_NODE_RED );
+                idx = grand_idx;
+                continue;
+            }
+            if( parent_node->left_idx==idx ){
+                hyrbtree_idx_right_rotate( tree,parent_idx );
+                idx = parent_idx;
+                parent_idx = hyrbtree_idx_parent( hyrbtree_idx_node(tree,idx) );
+                parent_node = hyrbtree_idx_node( tree,parent_idx );
+            }
+            hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_set_color( grand_node,HYRBTREE_NODE_RED );
+            hyrbtree_idx_left_rotate( tree,grand_idx );
+        }
+        break;
+    }
+    hyrbtree_idx_set_color( hyrbtree_idx_node(tree,tree->root_idx),HYRBTREE_NODE_BLACK );
+}
+
+/**
+ * @brief Restore balance after unlinking a black node
+ * @param tree Index tree
+ * @param idx Node that took the unlinked position, possibly NIL
+ * @param parent_idx Parent of that position
+ */
+static void hyrbtree_idx_del_balance( hyrbtree_idx_t *tree,hy_u32_t idx,hy_u32_t parent_idx ){
+    hyrbinode_t *parent_node;
+    hyrbinode_t *sibling_node;
+    hy_u32_t sibling_idx;
+
+    while( idx!=tree->root_idx && !hyrbtree_idx_is_red(tree,idx) ){
+        parent_node = hyrbtree_idx_node( tree,parent_idx );
+        if( parent_node->left_idx==idx ){
+            sibling_idx = parent_node->right_idx;
+            if( hyrbtree_idx_is_red(tree,sibling_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_RED );
+                hyrbtree_idx_left_rotate( tree,parent_idx );
+                sibling_idx = parent_node->right_idx;
+            }
+            sibling_node = hyrbtree_idx_node( tree,sibling_idx );
+            if( !hyrbtree_idx_is_red(tree,sibling_node->left_idx) && !hyrbtree_idx_is_red(tree,sibling_node->right_idx) ){
+                hyrbtree_idx_set_color( sibling_node,HYRBTREE_NODE_RED );
+                idx = parent_idx;
+                parent_idx = hyrbtree_idx_parent( parent_node );
+                continue;
+            }
+            if( !hyrbtree_idx_is_red(tree,sibling_node->right_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_node->left_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( sibling_node,HYRBTREE_NODE_RED );
+                hyrbtree_idx_right_rotate( tree,sibling_idx );
+                sibling_idx = parent_node->right_idx;
+                sibling_node = hyrbtree_idx_node( tree,sibling_idx );
+            }
+            hyrbtree_idx_set_color( sibling_node,(parent_node->parent_idx & HYRBTREE_IDX_COLOR_BIT)!=0 );
+            hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_node->right_idx),HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_left_rotate( tree,parent_idx );
+        }
+        else{
+            sibling_idx = parent_node->left_idx;
+            if( hyrbtree_idx_is_red(tree,sibling_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_RED );
+                hyrbtree_idx_right_rotate( tree,parent_idx );
+                sibling_idx = parent_node->left_idx;
+            }
+            sibling_node = hyrbtree_idx_node( tree,sibling_idx );
+            if( !hyrbtree_idx_is_red(tree,sibling_node->left_idx) && !hyrbtree_idx_is_red(tree,sibling_node->right_idx) ){
+                hyrbtree_idx_set_color( sibling_node,HYRBTREE_NODE_RED );
+                idx = parent_idx;
+                parent_idx = hyrbtree_idx_parent( parent_node );
+                continue;
+            }
+            if( !hyrbtree_idx_is_red(tree,sibling_node->left_idx) ){
+                hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_node->right_idx),HYRBTREE_NODE_BLACK );
+                hyrbtree_idx_set_color( sibling_node,HYRBTREE_NODE_RED );
+                hyrbtree_idx_left_rotate( tree,sibling_idx );
+                sibling_idx = parent_node->left_idx;
+                sibling_node = hyrbtree_idx_node( tree,sibling_idx );
+            }
+            hyrbtree_idx_set_color( sibling_node,(parent_node->parent_idx & HYRBTREE_IDX_COLOR_BIT)!=0 );
+            hyrbtree_idx_set_color( parent_node,HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_set_color( hyrbtree_idx_node(tree,sibling_node->left_idx),HYRBTREE_NODE_BLACK );
+            hyrbtree_idx_right_rotate( tree,parent_idx );
+        }
+        idx = tree->root_idx;
+        break;
+    }
+    if( idx!=HYRBTREE_IDX_NIL ){
+        hyrbtree_idx_set_color( hyrbtree_idx_node(tree,idx),HYRBTREE_NODE_BLACK );
+    }
+}
+
+/**
+ * @brief Descend to the leftmost or rightmost node of a subtree
+ * @param tree Index tree
+ * @param idx Subtree root (not NIL)
+ * @param right Non-zero for the rightmost node
+ * @return Extreme node index
+ */
+static hy_u32_t hyrbtree_idx_extreme( hyrbtree_idx_t *tree,hy_u32_t idx,hy_u8_t right ){
+    hyrbinode_t *node;
+    hy_u32_t child_idx;
+
+    while( 1 ){
+        node = hyrbtree_idx_node( tree,idx );
+        child_idx = right!=0 ? node->right_idx : node->left_idx;
+        if( child_idx==HYRBTREE_IDX_NIL ){
+            return idx;
+        }
+        idx = child_idx;
+    }
+}
+
+
+
+/**
+ * @brief Initialize an index tree
+ * @param tree Index tree (array fields and cmp_elem set)
+ *
+ * Marks every array entry unlinked.
+ */
+void hyrbtree_idx_init( hyrbtree_idx_t *tree ){
+    hy_u32_t idx;
+
+    for( idx=0;idx<tree->node_num;idx++ ){
+        hyrbtree_idx_node(tree,idx)->left_idx = HYRBTREE_IDX_UNLINKED;
+    }
+    tree->node_count = 0;
+    tree->root_idx = HYRBTREE_IDX_NIL;
+}
+
+/**
+ * @brief Insert an array entry
+ * @param tree Index tree
+ * @param idx Entry to link (key already set)
+ * @param exist_idx [out] Returns existing entry if key exists
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_ADD_NODE_ELEM_EXIST: Key collision
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: Index out of range or already linked
+ */
+hyrbtree_ret_t hyrbtree_idx_add_node( hyrbtree_idx_t *tree,hy_u32_t idx,hy_u32_t *exist_idx ){
+    hyrbinode_t *add_node;
+    hyrbinode_t *parent_node;
+    hy_u32_t parent_idx;
+    hy_u32_t cur_idx;
+    hy_i32_t cmp_ret;
+    void *elem;
+
+    if( idx>=tree->node_num || hyrbtree_idx_node(tree,idx)->left_idx!=HYRBTREE_IDX_UNLINKED ){
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    }
+    add_node = hyrbtree_idx_node( tree,idx );
+    elem = hyrbtree_idx_elem( tree,idx );
+
+    parent_idx = HYRBTREE_IDX_NIL;
+    parent_node = HY_NULL;
+    cmp_ret = 0;
+    for( cur_idx=tree->root_idx;cur_idx!=HYRBTREE_IDX_NIL; ){
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_idx_elem(tree,cur_idx) );
+        if( cmp_ret==0 ){
+            *exist_idx = cur_idx;
+            return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
+        }
+        parent_idx = cur_idx;
+        parent_node = hyrbtree_idx_node( tree,cur_idx );
+        cur_idx = cmp_ret<0 ? parent_node->left_idx : parent_node->right_idx;
+    }
+
+    add_node->parent_idx = parent_idx;
+    add_node->left_idx = HYRBTREE_IDX_NIL;
+    add_node->right_idx = HYRBTREE_IDX_NIL;
+    if( parent_node==HY_NULL ){
+        tree->root_idx = idx;
+    }
+    else if( cmp_ret<0 ){
+        parent_node->left_idx = idx;
+    }
+    else{
+        parent_node->right_idx = idx;
+    }
+    tree->node_count++;
+
+    hyrbtree_idx_add_balance( tree,idx );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Delete an array entry
+ * @param tree Index tree
+ * @param idx Linked entry
+ * @return Operation status code
+ *
+ * A node with two children is replaced in place by its successor; the
+ * entry is left marked unlinked.
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_DEL_NODE_ARGS_ERROR: Index out of range or not linked
+ */
+hyrbtree_ret_t hyrbtree_idx_del_node( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *del_node;
+    hyrbinode_t *succ_node;
+    hy_u32_t succ_idx;
+    hy_u32_t child_idx;
+    hy_u32_t parent_idx;
+    hy_u32_t color;
+
+    if( idx>=tree->node_num || hyrbtree_idx_node(tree,idx)->left_idx==HYRBTREE_IDX_UNLINKED ){
+        return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;
+    }
+    del_node = hyrbtree_idx_node( tree,idx );
+
+    /* succ_idx is the node physically unlinked: idx itself or its successor */
+    if( del_node->left_idx==HYRBTREE_IDX_NIL || del_node->right_idx==HYRBTREE_IDX_NIL ){
+        succ_idx = idx;
+    }
+    else{
+        succ_idx = hyrbtree_idx_extreme( tree,del_node->right_idx,0 );
+    }
+    succ_node = hyrbtree_idx_node( tree,succ_idx );
+    child_idx = succ_node->left_idx!=HYRBTREE_IDX_NIL ? succ_node->left_idx : succ_node->right_idx;
+    parent_idx = hyrbtree_idx_parent( succ_node );
+    color = succ_node->parent_idx & HYRBTREE_IDX_COLOR_BIT;
+
+    if( child_idx!=HYRBTREE_IDX_NIL ){
+        hyrbtree_idx_set_parent( hyrbtree_idx_node(tree,child_idx),parent_idx );
+    }
+    hyrbtree_idx_change_child( tree,parent_idx,succ_idx,child_idx );
+
+    if( succ_idx!=idx ){
+        /* Move the successor into the deleted node's position and color */
+        if( parent_idx==idx ){
+            parent_idx = succ_idx;
+        }
+        succ_node->parent_idx = del_node->parent_idx;
+        succ_node->left_idx = del_node->left_idx;
+        succ_node->right_idx = del_node->right_idx;
+        hyrbtree_idx_change_child( tree,hyrbtree_idx_parent(del_node),idx,succ_idx );
+        hyrbtree_idx_set_parent( hyrbtree_idx_node(tree,succ_node->left_idx),succ_idx );
+        if( succ_node->right_idx!=HYRBTREE_IDX_NIL ){
+            hyrbtree_idx_set_parent( hyrbtree_idx_node(tree,succ_node->right_idx),succ_idx );
+        }
+    }
+
+    del_node->left_idx = HYRBTREE_IDX_UNLINKED;
+    tree->node_count--;
+    if( color!=0 ){
+        hyrbtree_idx_del_balance( tree,child_idx,parent_idx );
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Find an entry by key
+ * @param tree Index tree
+ * @param elem Key to search
+ * @param get_idx [out] Found entry
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Key not present
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_idx_get_node( hyrbtree_idx_t *tree,void *elem,hy_u32_t *get_idx ){
+    hy_u32_t cur_idx;
+    hy_i32_t cmp_ret;
+
+    cur_idx = tree->root_idx;
+    if( cur_idx==HYRBTREE_IDX_NIL ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    while( cur_idx!=HYRBTREE_IDX_NIL ){
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_idx_elem(tree,cur_idx) );
+        if( cmp_ret==0 ){
+            *get_idx = cur_idx;
+            return HYRBTREE_RET_OK;
+        }
+        cur_idx = cmp_ret<0 ? hyrbtree_idx_node(tree,cur_idx)->left_idx : hyrbtree_idx_node(tree,cur_idx)->right_idx;
+    }
+    return HYRBTREE_RET_GET_NODE_NOT_FIND;
+}
+
+/**
+ * @brief Entry with the smallest key
+ * @param tree Index tree
+ * @return Entry index, HYRBTREE_IDX_NIL if empty
+ */
+hy_u32_t hyrbtree_idx_first( hyrbtree_idx_t *tree ){
+    if( tree->root_idx==HYRBTREE_IDX_NIL ){
+        return HYRBTREE_IDX_NIL;
+    }
+    return hyrbtree_idx_extreme( tree,tree->root_idx,0 );
+}
+
+/**
+ * @brief Entry with the largest key
+ * @param tree Index tree
+ * @return Entry index, HYRBTREE_IDX_NIL if empty
+ */
+hy_u32_t hyrbtree_idx_last( hyrbtree_idx_t *tree ){
+    if( tree->root_idx==HYRBTREE_IDX_NIL ){
+        return HYRBTREE_IDX_NIL;
+    }
+    return hyrbtree_idx_extreme( tree,tree->root_idx,1 );
+}
+
+/**
+ * @brief In-order successor
+ * @param tree Index tree
+ * @param idx Linked entry
+ * @return Next entry, HYRBTREE_IDX_NIL after the last
+ */
+hy_u32_t hyrbtree_idx_next( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *node;
+    hy_u32_t parent_idx;
+
+    node = hyrbtree_idx_node( tree,idx );
+    if( node->right_idx!=HYRBTREE_IDX_NIL ){
+        return hyrbtree_idx_extreme( tree,node->right_idx,0 );
+    }
+    parent_idx = hyrbtree_idx_parent( node );
+    while( parent_idx!=HYRBTREE_IDX_NIL && hyrbtree_idx_node(tree,parent_idx)->right_idx==idx ){
+        idx = parent_idx;
+        parent_idx = hyrbtree_idx_parent( hyrbtree_idx_node(tree,idx) );
+    }
+    return parent_idx;
+}
+
+/**
+ * @brief In-order predecessor
+ * @param tree Index tree
+ * @param idx Linked entry
+ * @return Previous entry, HYRBTREE_IDX_NIL before the first
+ */
+hy_u32_t hyrbtree_idx_prev( hyrbtree_idx_t *tree,hy_u32_t idx ){
+    hyrbinode_t *node;
+    hy_u32_t parent_idx;
+
+    node = hyrbtree_idx_node( tree,idx );
+    if( node->left_idx!=HYRBTREE_IDX_NIL ){
+        return hyrbtree_idx_extreme( tree,node->left_idx,1 );
+    }
+    parent_idx = hyrbtree_idx_parent( node );
+    while( parent_idx!=HYRBTREE_IDX_NIL && hyrbtree_idx_node(tree,parent_idx)->left_idx==idx ){
+        idx = parent_idx;
+        parent_idx = hyrbtree_idx_parent( hyrbtree_idx_node(tree,idx) );
+    }
+    return parent_idx;
+}
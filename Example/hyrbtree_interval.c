@@ -0,0 +1,250 @@
+/**
+ * @file hyrbtree_interval.c
+ * @brief Interval Tree Implementation
+ */
+
+#include "hyrbtree_interval.h"
+
+
+
+/* Macro to get the interval embedding a linked rbnode */
+#define HYRBTREE_INTERVAL_OF(n)         HYRBTREE_CONTAINER_OF(n,hyrbtree_interval_t,rbnode)
+
+
+
+/**
+ * @brief Order intervals by start, then by node address
+ * @param elem1 start of the first interval
+ * @param elem2 start of the second interval
+ * @return <0, 0 or >0
+ *
+ * start is the first member, so distinct nodes never compare equal and
+ * intervals sharing a start coexist.
+ */
+static hy_i32_t hyrbtree_interval_cmp( void *elem1,void *elem2 ){
+    hy_u64_t start1 = *(hy_u64_t *)elem1;
+    hy_u64_t start2 = *(hy_u64_t *)elem2;
+
+    if( start1!=start2 ){
+        return start1<start2 ? -1 : 1;
+    }
+    if( elem1!=elem2 ){
+        return (hy_uptr_t)elem1<(hy_uptr_t)elem2 ? -1 : 1;
+    }
+    return 0;
+}
+
+#if HYRBTREE_CFG_KEY_CACHE
+/**
+ * @brief Project an interval start onto the node key cache
+ * @param elem start of an interval
+ * @return start itself
+ */
+static hy_u64_t hyrbtree_interval_cache( void *elem ){
+    return HYRBTREE_ELEM_CACHE_UINT(*(hy_u64_t *)elem);
+}
+#endif
+
+/**
+ * @brief Recompute max_end from the children
+ * @param user_node Interval
+ * @param left_node Left child interval or HY_NULL
+ * @param right_node Right child interval or HY_NULL
+ * @return 1 if max_end changed
+ */
+static hy_u8_t hyrbtree_interval_augment( void *user_node,void *left_node,void *right_node ){
+    hyrbtree_interval_t *interval = (hyrbtree_interval_t *)user_node;
+    hy_u64_t max_end = interval->end;
+
+    if( left_node!=HY_NULL && ((hyrbtree_interval_t *)left_node)->max_end>max_end ){
+        max_end = ((hyrbtree_interval_t *)left_node)->max_end;
+    }
+    if( right_node!=HY_NULL && ((hyrbtree_interval_t *)right_node)->max_end>max_end ){
+        max_end = ((hyrbtree_interval_t *)right_node)->max_end;
+    }
+    if( interval->max_end==max_end ){
+        return 0;
+    }
+    interval->max_end = max_end;
+    return 1;
+}
+
+
+
+/**
+ * @brief Initialize an interval tree
+ * @param tree Tree structure
+ *
+ * Registers the interval layout, ordering and max_end augmentation, then
+ * initializes the tree. The core iteration API (hyrbtree_first/next...)
+ * works unchanged and yields hyrbtree_interval_t pointers.
+ */
+void hyrbtree_interval_init( hyrbtree_t *tree ){
+    tree->get_rbnode = HY_NULL;
+    tree->get_elem = HY_NULL;
+    tree->cmp_elem = hyrbtree_interval_cmp;
+#if HYRBTREE_CFG_KEY_CACHE
+    tree->get_elem_cache = hyrbtree_interval_cache;
+#endif
+    tree->augment_node = hyrbtree_interval_augment;
+    tree->rbnode_offset = offsetof(hyrbtree_interval_t,rbnode);
+    tree->elem_offset = offsetof(hyrbtree_interval_t,start);
+    tree->multi_elem = 0;
+    hyrbtree_init( tree );
+}
+
+/**
+ * @brief Insert the interval [start,end]
+ * @param tree Interval tree
+ * @param interval Detached interval node (rbnode.user_node cleared)
+ * @param start Inclusive lower end
+ * @param end Inclusive upper end
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Success
+ * - HYRBTREE_RET_INTERVAL_RANGE_ERROR: end < start
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: Node already linked
+ */
+hyrbtree_ret_t hyrbtree_interval_add( hyrbtree_t *tree,hyrbtree_interval_t *interval,
+    hy_u64_t start,hy_u64_t end ){
+
+    void *exist_node;
+
+    if( end<start ){
+        return HYRBTREE_RET_INTERVAL_RANGE_ERROR;
+    }
+    if( HYRBTREE_GET_NODE_ADDR(&interval->rbnode)!=HY_NULL ){
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    }
+    interval->start = start;
+    interval->end = end;
+    interval->max_end = end;
+    return hyrbtree_add_node( tree,interval,&exist_node );
+}
+
+/**
+ * @brief Remove an interval
+ * @param tree Interval tree
+ * @param interval Interval linked in tree
+ * @return Operation status code (see hyrbtree_del_node)
+ */
+hyrbtree_ret_t hyrbtree_interval_del( hyrbtree_t *tree,hyrbtree_interval_t *interval ){
+    return hyrbtree_del_node( tree,interval );
+}
+
+
+
+/**
+ * @brief Visit overlapping intervals of one subtree in start order
+ * @param tree Interval tree
+ * @param node Subtree root (nil_node allowed)
+ * @param lo Query lower end
+ * @param hi Query upper end
+ * @param visit Visitor
+ * @param arg User argument
+ * @return Non-zero once visit asked to stop
+ *
+ * Skips subtrees whose max_end is below lo and right subtrees once start
+ * passes hi. Recursion depth is bounded by the tree height.
+ */
+static hy_u8_t hyrbtree_interval_overlap_subtree( hyrbtree_t *tree,hyrbnode_t *node,
+    hy_u64_t lo,hy_u64_t hi,hyrbtree_visit_t visit,void *arg ){
+
+    hyrbtree_interval_t *interval;
+
+    while( node!=&tree->nil_node ){
+        interval = HYRBTREE_INTERVAL_OF(node);
+        if( interval->max_end<lo ){
+            return 0;
+        }
+        if( hyrbtree_interval_overlap_subtree( tree,node->left_node,lo,hi,visit,arg )!=0 ){
+            return 1;
+        }
+        if( interval->start>hi ){
+            return 0;
+        }
+        if( interval->end>=lo && visit(interval,arg)!=0 ){
+            return 1;
+        }
+        node = node->right_node;
+    }
+    return 0;
+}
+
+/**
+ * @brief Visit every interval overlapping [lo,hi]
+ * @param tree Interval tree
+ * @param lo Query lower end
+ * @param hi Query upper end
+ * @param visit Called with each overlapping hyrbtree_interval_t in start order
+ * @param arg User argument passed to visit
+ * @return Operation status code
+ *
+ * O(min(n, (k+1) log n)) for k reported intervals: a subtree is skipped
+ * once its max_end is below lo, but one whose max_end reaches lo only
+ * through intervals starting after hi still costs a descent. visit must
+ * not modify the tree; returning non-zero stops the scan.
+ * Returns:
+ * - HYRBTREE_RET_OK: Scan complete or stopped by visit
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_interval_overlap( hyrbtree_t *tree,hy_u64_t lo,hy_u64_t hi,
+    hyrbtree_visit_t visit,void *arg ){
+
+    if( tree->root_node!=&tree->nil_node ){
+        if( lo<=hi ){
+            hyrbtree_interval_overlap_subtree( tree,tree->root_node,lo,hi,visit,arg );
+        }
+        return HYRBTREE_RET_OK;
+    }
+    return HYRBTREE_RET_GET_NODE_TREE_NULL;
+}
+
+/**
+ * @brief Find any interval containing point
+ * @param tree Interval tree
+ * @param point Query point
+ * @param get_interval [out] Containing interval
+ * @return Operation status code
+ *
+ * Single descent: go left whenever the left subtree reaches point, since
+ * otherwise no interval there can contain it.
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: No interval contains point
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty tree
+ */
+hyrbtree_ret_t hyrbtree_interval_stab( hyrbtree_t *tree,hy_u64_t point,
+    hyrbtree_interval_t **get_interval ){
+
+    hyrbnode_t *cur_node;
+    hyrbtree_interval_t *interval;
+
+    if( tree->root_node==&tree->nil_node ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    cur_node = tree->root_node;
+    while( cur_node!=&tree->nil_node ){
+        interval = HYRBTREE_INTERVAL_OF(cur_node);
+        if( interval->max_end<point ){
+            break;
+        }
+        if( interval->start<=point && point<=interval->end ){
+            *get_interval = interval;
+            return HYRBTREE_RET_OK;
+        }
+        if( cur_node->left_node!=&tree->nil_node &&
+            HYRBTREE_INTERVAL_OF(cur_node->left_node)->max_end>=point ){
+            cur_node = cur_node->left_node;
+        }
+        else if( interval->start>point ){
+            break;
+        }
+        else{
+            cur_node = cur_node->right_node;
+        }
+    }
+    return HYRBTREE_RET_GET_NODE_NOT_FIND;
+}
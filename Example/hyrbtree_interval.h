@@ -0,0 +1,44 @@
+/**
+ * @file hyrbtree_interval.h
+ * @brief Interval Tree on top of the Embedded Red-Black Tree
+ *
+ * Closed intervals [start,end] keyed by start and augmented with the
+ * largest end in each subtree:
+ * - Intrusive, zero-allocation hyrbtree_interval_t embedding
+ * - Equal starts allowed (ties ordered by node address)
+ * - Overlap enumeration in O(min(n, (k+1) log n))
+ * - Stabbing query in O(log n)
+ */
+
+#ifndef HYRBTREE_INTERVAL_H
+#define HYRBTREE_INTERVAL_H
+
+#include "hyrbtree.h"
+
+
+
+/**
+ * @brief Interval node, embed in user structures
+ *
+ * Recover the container with HYRBTREE_CONTAINER_OF(interval,type,member).
+ */
+typedef struct{
+    hy_u64_t start;         ///< Inclusive lower end (tree key)
+    hy_u64_t end;           ///< Inclusive upper end
+    hy_u64_t max_end;       ///< Largest end in this subtree (maintained by the tree)
+    hyrbnode_t rbnode;      ///< Embedded tree node
+}hyrbtree_interval_t;
+
+
+
+/* Interval Tree API */
+void hyrbtree_interval_init( hyrbtree_t *tree );
+hyrbtree_ret_t hyrbtree_interval_add( hyrbtree_t *tree,hyrbtree_interval_t *interval,
+    hy_u64_t start,hy_u64_t end );
+hyrbtree_ret_t hyrbtree_interval_del( hyrbtree_t *tree,hyrbtree_interval_t *interval );
+hyrbtree_ret_t hyrbtree_interval_overlap( hyrbtree_t *tree,hy_u64_t lo,hy_u64_t hi,
+    hyrbtree_visit_t visit,void *arg );
+hyrbtree_ret_t hyrbtree_interval_stab( hyrbtree_t *tree,hy_u64_t point,
+    hyrbtree_interval_t **get_interval );
+
+#endif
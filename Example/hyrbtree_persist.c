@@ -0,0 +1,638 @@
+/**
+ * @file hyrbtree_persist.c
+ * @brief Persistent (Path-Copying) Red-Black Tree Implementation
+ *
+ * A node is writable in place only while its ref_count is 1 and every
+ * ancestor is writable, i.e. only the current version can reach it. Writers
+ * descend from the root making each node on the path writable (copying it
+ * if shared), so balancing only ever rewrites private nodes. Siblings
+ * recolored or rotated by balancing are made writable the same way.
+ *
+ * Every node a write may need is reserved in spare_node before the tree is
+ * touched, so an allocation failure leaves the current version unchanged.
+ */
+
+#include "hyrbtree_persist.h"
+
+
+
+/**
+ * @brief Locate the key of a node
+ * @param tree Persistent tree
+ * @param node Tree node
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_persist_elem( hyrbtree_persist_t *tree,hyrbtree_pnode_t *node ){
+    if( tree->get_elem!=HY_NULL ){
+        return tree->get_elem(node->user_node);
+    }
+    return (void *)((hy_u8_t *)node->user_node+tree->elem_offset);
+}
+
+/**
+ * @brief Check node color, HY_NULL counts as black
+ * @param node Tree node or HY_NULL
+ * @return Non-zero if red
+ */
+static inline hy_u8_t hyrbtree_persist_is_red( hyrbtree_pnode_t *node ){
+    return node!=HY_NULL && node->color==HYRBTREE_NODE_RED;
+}
+
+/**
+ * @brief Take a reference on a node
+ * @param node Tree node or HY_NULL
+ */
+static inline void hyrbtree_persist_hold( hyrbtree_pnode_t *node ){
+    if( node!=HY_NULL ){
+        __atomic_add_fetch(&node->ref_count,1,__ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Drop a reference on a node, freeing it and its unshared descendants
+ * @param tree Persistent tree
+ * @param node Tree node or HY_NULL
+ *
+ * Recurses on the left child and loops on the right one, so the stack
+ * depth is bounded by the tree height.
+ */
+static void hyrbtree_persist_put( hyrbtree_persist_t *tree,hyrbtree_pnode_t *node ){
+    hyrbtree_pnode_t *right_node;
+
+    while( node!=HY_NULL && __atomic_sub_fetch(&node->ref_count,1,__ATOMIC_ACQ_REL)==0 ){
+        hyrbtree_persist_put( tree,node->left_node );
+        right_node = node->right_node;
+        tree->free_node( node,tree->alloc_arg );
+        node = right_node;
+    }
+}
+
+/**
+ * @brief Fill the spare list up to a node count
+ * @param tree Persistent tree
+ * @param need Nodes required
+ * @return Non-zero on success
+ */
+static hy_u8_t hyrbtree_persist_reserve( hyrbtree_persist_t *tree,hy_u32_t need ){
+    hyrbtree_pnode_t *node;
+
+    while( tree->spare_num<need ){
+        node = tree->alloc_node( tree->alloc_arg );
+        if( node==HY_NULL ){
+            return 0;
+        }
+        node->left_node = tree->spare_node;
+        tree->spare_node = node;
+        tree->spare_num++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Take a reserved node
+ * @param tree Persistent tree
+ * @return Uninitialized node
+ */
+static inline hyrbtree_pnode_t *hyrbtree_persist_take( hyrbtree_persist_t *tree ){
+    hyrbtree_pnode_t *node;
+
+    node = tree->spare_node;
+    tree->spare_node = node->left_node;
+    tree->spare_num--;
+    return node;
+}
+
+/**
+ * @brief Upper bound on the height of the current version
+ * @param tree Persistent tree
+ * @return 2*ceil(log2(node_count+1))
+ */
+static hy_u32_t hyrbtree_persist_max_height( hyrbtree_persist_t *tree ){
+    hy_u64_t count;
+    hy_u32_t bits;
+
+    bits = 0;
+    for( count=(hy_u64_t)tree->node_count+1;count!=0;count>>=1 ){
+        bits++;
+    }
+    return 2*bits;
+}
+
+/**
+ * @brief Make the node in a link writable
+ * @param tree Persistent tree
+ * @param link Link from a writable parent (or the root link)
+ * @return Private node now stored in link
+ *
+ * A shared node is replaced by a copy that takes references on its
+ * children; the original loses the reference the link held.
+ */
+static hyrbtree_pnode_t *hyrbtree_persist_own( hyrbtree_persist_t *tree,hyrbtree_pnode_t **link ){
+    hyrbtree_pnode_t *node;
+    hyrbtree_pnode_t *copy_node;
+
+    node = *link;
+    if( __atomic_load_n(&node->ref_count,__ATOMIC_ACQUIRE)==1 ){
+        return node;
+    }
+    copy_node = hyrbtree_persist_take( tree );
+    copy_node->left_node = node->left_node;
+    copy_node->right_node = node->right_node;
+    copy_node->user_node = node->user_node;
+    copy_node->color = node->color;
+    copy_node->ref_count = 1;
+    hyrbtree_persist_hold( copy_node->left_node );
+    hyrbtree_persist_hold( copy_node->right_node );
+    *link = copy_node;
+    hyrbtree_persist_put( tree,node );
+    return copy_node;
+}
+
+/**
+ * @brief Get the link of a path entry
+ * @param tree Persistent tree
+ * @param path Writable nodes from the root
+ * @param dir Direction taken from each path entry (0 left, 1 right)
+ * @param depth Path index of the node whose link is wanted
+ * @return Link in the parent, or the root link
+ */
+static inline hyrbtree_pnode_t **hyrbtree_persist_link( hyrbtree_persist_t *tree,hyrbtree_pnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    if( depth<=0 ){
+        return &tree->root_node;
+    }
+    return dir[depth-1]==0 ? &path[depth-1]->left_node : &path[depth-1]->right_node;
+}
+
+/**
+ * @brief Rotate left, returning the new subtree root
+ * @param node Writable subtree root with writable right child
+ * @return New subtree root
+ */
+static inline hyrbtree_pnode_t *hyrbtree_persist_rotate_left( hyrbtree_pnode_t *node ){
+    hyrbtree_pnode_t *right_node;
+
+    right_node = node->right_node;
+    node->right_node = right_node->left_node;
+    right_node->left_node = node;
+    return right_node;
+}
+
+/**
+ * @brief Rotate right, returning the new subtree root
+ * @param node Writable subtree root with writable left child
+ * @return New subtree root
+ */
+static inline hyrbtree_pnode_t *hyrbtree_persist_rotate_right( hyrbtree_pnode_t *node ){
+    hyrbtree_pnode_t *left_node;
+
+    left_node = node->left_node;
+    node->left_node = left_node->right_node;
+    left_node->right_node = node;
+    return left_node;
+}
+
+/**
+ * @brief Find a key in a version
+ * @param tree Persistent tree
+ * @param node Version root
+ * @param elem Key to search
+ * @return Node holding the key, HY_NULL if absent
+ */
+static hyrbtree_pnode_t *hyrbtree_persist_find( hyrbtree_persist_t *tree,hyrbtree_pnode_t *node,void *elem ){
+    hy_i32_t cmp_ret;
+
+    while( node!=HY_NULL ){
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_persist_elem(tree,node) );
+        if( cmp_ret==0 ){
+            return node;
+        }
+        node = cmp_ret<0 ? node->left_node : node->right_node;
+    }
+    return HY_NULL;
+}
+
+/**
+ * @brief Restore balance after linking a red leaf
+ * @param tree Persistent tree
+ * @param path Writable path, path[depth] is the new leaf
+ * @param dir Direction taken from each path entry
+ * @param depth Path index of the new leaf
+ */
+static void hyrbtree_persist_add_balance( hyrbtree_persist_t *tree,hyrbtree_pnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    hyrbtree_pnode_t *parent_node;
+    hyrbtree_pnode_t *grand_node;
+    hyrbtree_pnode_t *uncle_node;
+    hyrbtree_pnode_t **uncle_link;
+
+    while( depth>=2 && hyrbtree_persist_is_red(path[depth-1]) ){
+        parent_node = path[depth-1];
+        grand_node = path[depth-2];
+        uncle_link = dir[depth-2]==0 ? &grand_node->right_node : &grand_node->left_node;
+        if( hyrbtree_persist_is_red(*uncle_link) ){
+            uncle_node = hyrbtree_persist_own( tree,uncle_link );
+            uncle_node->color = HYRBTREE_NODE_BLACK;
+            parent_node->color = HYRBTREE_NODE_BLACK;
+            grand_node->color = HYRBTREE_NODE_RED;
+            depth -= 2;
+            continue;
+        }
+
+        if( dir[depth-2]==0 ){
+            if( dir[depth-1]==1 ){
+                grand_node->left_node = hyrbtree_persist_rotate_left( parent_node );
+                parent_node = grand_node->left_node;
+            }
+            *hyrbtree_persist_link( tree,path,dir,depth-2 ) = hyrbtree_persist_rotate_right( grand_node );
+        }
+        else{
+            if( dir[depth-1]==0 ){
+                grand_node->right_node = hyrbtree_persist_rotate_right( parent_node );
+                parent_node = grand_node->right_node;
+            }
+            *hyrbtree_persist_link( tree,path,dir,depth-2 ) = hyrbtree_persist_rotate_left( grand_node );
+        }
+        parent_node->color = HYRBTREE_NODE_BLACK;
+        grand_node->color = HYRBTREE_NODE_RED;
+        break;
+    }
+    tree->root_node->color = HYRBTREE_NODE_BLACK;
+}
+
+/**
+ * @brief Restore balance after unlinking a black node
+ * @param tree Persistent tree
+ * @param path Writable path, path[depth] is the parent of the unlinked node
+ * @param dir Direction taken from each path entry
+ * @param depth Path index of the parent, -1 if the root was unlinked
+ *
+ * The child that took the unlinked node's place (possibly HY_NULL) carries
+ * the missing black; it lies at dir[depth] below path[depth].
+ */
+static void hyrbtree_persist_del_balance( hyrbtree_persist_t *tree,hyrbtree_pnode_t **path,
+    hy_u8_t *dir,hy_i32_t depth ){
+
+    hyrbtree_pnode_t *parent_node;
+    hyrbtree_pnode_t *sibling_node;
+    hyrbtree_pnode_t *nephew_node;
+    hyrbtree_pnode_t **fix_link;
+
+    fix_link = depth<0 ? &tree->root_node : ( dir[depth]==0 ? &path[depth]->left_node : &path[depth]->right_node );
+    while( depth>=0 && !hyrbtree_persist_is_red(*fix_link) ){
+        parent_node = path[depth];
+        if( dir[depth]==0 ){
+            sibling_node = hyrbtree_persist_own( tree,&parent_node->right_node );
+            if( sibling_node->color==HYRBTREE_NODE_RED ){
+                sibling_node->color = HYRBTREE_NODE_BLACK;
+                parent_node->color = HYRBTREE_NODE_RED;
+                *hyrbtree_persist_link( tree,path,dir,depth ) = hyrbtree_persist_rotate_left( parent_node );
+                path[depth] = sibling_node;
+                dir[depth] = 0;
+                depth++;
+                path[depth] = parent_node;
+                dir[depth] = 0;
+                sibling_node = hyrbtree_persist_own( tree,&parent_node->right_node );
+            }
+            if( !hyrbtree_persist_is_red(sibling_node->left_node) && !hyrbtree_persist_is_red(sibling_node->right_node) ){
+                sibling_node->color = HYRBTREE_NODE_RED;
+                depth--;
+                fix_link = hyrbtree_persist_link( tree,path,dir,depth+1 );
+                continue;
+            }
+            if( !hyrbtree_persist_is_red(sibling_node->right_node) ){
+                nephew_node = hyrbtree_persist_own( tree,&sibling_node->left_node );
+                nephew_node->color = HYRBTREE_NODE_BLACK;
+                sibling_node->color = HYRBTREE_NODE_RED;
+                parent_node->right_node = hyrbtree_persist_rotate_right( sibling_node );
+                sibling_node = nephew_node;
+            }
+            sibling_node->color = parent_node->color;
+            parent_node->color = HYRBTREE_NODE_BLACK;
+            nephew_node = hyrbtree_persist_own( tree,&sibling_node->right_node );
+            nephew_node->color = HYRBTREE_NODE_BLACK;
+            *hyrbtree_persist_link( tree,path,dir,depth ) = hyrbtree_persist_rotate_left( parent_node );
+        }
+        else{
+            sibling_node = hyrbtree_persist_own( tree,&parent_node->left_node );
+            if( sibling_node->color==HYRBTREE_NODE_RED ){
+                sibling_node->color = HYRBTREE_NODE_BLACK;
+                parent_node->color = HYRBTREE_NODE_RED;
+                *hyrbtree_persist_link( tree,path,dir,depth ) = hyrbtree_persist_rotate_right( parent_node );
+                path[depth] = sibling_node;
+                dir[depth] = 1;
+                depth++;
+                path[depth] = parent_node;
+                dir[depth] = 1;
+                sibling_node = hyrbtree_persist_own( tree,&parent_node->left_node );
+            }
+            if( !hyrbtree_persist_is_red(sibling_node->left_node) && !hyrbtree_persist_is_red(sibling_node->right_node) ){
+                sibling_node->color = HYRBTREE_NODE_RED;
+                depth--;
+                fix_link = hyrbtree_persist_link( tree,path,dir,depth+1 );
+                continue;
+            }
+            if( !hyrbtree_persist_is_red(sibling_node->left_node) ){
+                nephew_node = hyrbtree_persist_own( tree,&sibling_node->right_node );
+                nephew_node->color = HYRBTREE_NODE_BLACK;
+                sibling_node->color = HYRBTREE_NODE_RED;
+                parent_node->left_node = hyrbtree_persist_rotate_left( sibling_node );
+                sibling_node = nephew_node;
+            }
+            sibling_node->color = parent_node->color;
+            parent_node->color = HYRBTREE_NODE_BLACK;
+            nephew_node = hyrbtree_persist_own( tree,&sibling_node->left_node );
+            nephew_node->color = HYRBTREE_NODE_BLACK;
+            *hyrbtree_persist_link( tree,path,dir,depth ) = hyrbtree_persist_rotate_right( parent_node );
+        }
+        return;
+    }
+    if( *fix_link!=HY_NULL && (*fix_link)->color==HYRBTREE_NODE_RED ){
+        hyrbtree_persist_own( tree,fix_link )->color = HYRBTREE_NODE_BLACK;
+    }
+}
+
+
+
+/**
+ * @brief Initialize a persistent tree
+ * @param tree Persistent tree (callbacks set)
+ */
+void hyrbtree_persist_init( hyrbtree_persist_t *tree ){
+    tree->root_node = HY_NULL;
+    tree->node_count = 0;
+    tree->spare_node = HY_NULL;
+    tree->spare_num = 0;
+}
+
+/**
+ * @brief Drop the current version and the spare nodes
+ * @param tree Persistent tree
+ *
+ * Nodes still held by snapshots are freed when those are released.
+ */
+void hyrbtree_persist_clear( hyrbtree_persist_t *tree ){
+    hyrbtree_pnode_t *node;
+
+    hyrbtree_persist_put( tree,tree->root_node );
+    tree->root_node = HY_NULL;
+    tree->node_count = 0;
+    while( tree->spare_node!=HY_NULL ){
+        node = hyrbtree_persist_take( tree );
+        tree->free_node( node,tree->alloc_arg );
+    }
+}
+
+/**
+ * @brief Insert user data into the current version
+ * @param tree Persistent tree
+ * @param user_node User data
+ * @param exist_node [out] Returns existing user data if key exists
+ * @return Operation status code
+ *
+ * Copies the shared nodes on the insertion path; snapshots are unaffected.
+ * Returns:
+ * - HYRBTREE_RET_OK: Insert success
+ * - HYRBTREE_RET_ADD_NODE_ELEM_EXIST: Key exists (see exist_node)
+ * - HYRBTREE_RET_PERSIST_ALLOC_ERROR: alloc_node failed, tree unchanged
+ */
+hyrbtree_ret_t hyrbtree_persist_add_node( hyrbtree_persist_t *tree,void *user_node,void **exist_node ){
+    hyrbtree_pnode_t *path[HYRBTREE_PERSIST_MAX_DEPTH];
+    hy_u8_t dir[HYRBTREE_PERSIST_MAX_DEPTH];
+    hyrbtree_pnode_t **link;
+    hyrbtree_pnode_t *node;
+    hy_u32_t max_height;
+    hy_i32_t depth;
+    void *elem;
+
+    elem = tree->get_elem!=HY_NULL ? tree->get_elem(user_node) : (void *)((hy_u8_t *)user_node+tree->elem_offset);
+    node = hyrbtree_persist_find( tree,tree->root_node,elem );
+    if( node!=HY_NULL ){
+        *exist_node = node->user_node;
+        return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;
+    }
+
+    /* Path copies, the new leaf and one recolored uncle per two levels */
+    max_height = hyrbtree_persist_max_height( tree );
+    if( hyrbtree_persist_reserve(tree,max_height+max_height/2+2)==0 ){
+        return HYRBTREE_RET_PERSIST_ALLOC_ERROR;
+    }
+
+    link = &tree->root_node;
+    depth = 0;
+    while( *link!=HY_NULL ){
+        node = hyrbtree_persist_own( tree,link );
+        path[depth] = node;
+        dir[depth] = tree->cmp_elem( elem,hyrbtree_persist_elem(tree,node) )<0 ? 0 : 1;
+        link = dir[depth]==0 ? &node->left_node : &node->right_node;
+        depth++;
+    }
+
+    node = hyrbtree_persist_take( tree );
+    node->left_node = HY_NULL;
+    node->right_node = HY_NULL;
+    node->user_node = user_node;
+    node->ref_count = 1;
+    node->color = HYRBTREE_NODE_RED;
+    *link = node;
+    path[depth] = node;
+    tree->node_count++;
+
+    hyrbtree_persist_add_balance( tree,path,dir,depth );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Remove a key from the current version
+ * @param tree Persistent tree
+ * @param elem Key to remove
+ * @param del_node [out] Removed user data (still referenced by snapshots)
+ * @return Operation status code
+ *
+ * Copies the shared nodes on the removal path; snapshots are unaffected.
+ * Returns:
+ * - HYRBTREE_RET_OK: Delete success
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Key not present
+ * - HYRBTREE_RET_PERSIST_ALLOC_ERROR: alloc_node failed, tree unchanged
+ */
+hyrbtree_ret_t hyrbtree_persist_del_node( hyrbtree_persist_t *tree,void *elem,void **del_node ){
+    hyrbtree_pnode_t *path[HYRBTREE_PERSIST_MAX_DEPTH+1];
+    hy_u8_t dir[HYRBTREE_PERSIST_MAX_DEPTH+1];
+    hyrbtree_pnode_t **link;
+    hyrbtree_pnode_t *node;
+    hyrbtree_pnode_t *target_node;
+    hy_u32_t max_height;
+    hy_i32_t depth;
+    hy_i32_t cmp_ret;
+    hy_u8_t color;
+
+    if( hyrbtree_persist_find(tree,tree->root_node,elem)==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+
+    /* Path copies, then up to one sibling per level and three at the end */
+    max_height = hyrbtree_persist_max_height( tree );
+    if( hyrbtree_persist_reserve(tree,2*max_height+4)==0 ){
+        return HYRBTREE_RET_PERSIST_ALLOC_ERROR;
+    }
+
+    /* Copy the path down to the key */
+    link = &tree->root_node;
+    depth = 0;
+    while( 1 ){
+        node = hyrbtree_persist_own( tree,link );
+        path[depth] = node;
+        cmp_ret = tree->cmp_elem( elem,hyrbtree_persist_elem(tree,node) );
+        if( cmp_ret==0 ){
+            break;
+        }
+        dir[depth] = cmp_ret<0 ? 0 : 1;
+        link = dir[depth]==0 ? &node->left_node : &node->right_node;
+        depth++;
+    }
+    target_node = node;
+    *del_node = target_node->user_node;
+
+    /* Two children: continue to the successor and move its data up */
+    if( node->left_node!=HY_NULL && node->right_node!=HY_NULL ){
+        dir[depth] = 1;
+        link = &node->right_node;
+        depth++;
+        while( 1 ){
+            node = hyrbtree_persist_own( tree,link );
+            path[depth] = node;
+            if( node->left_node==HY_NULL ){
+                break;
+            }
+            dir[depth] = 0;
+            link = &node->left_node;
+            depth++;
+        }
+        target_node->user_node = node->user_node;
+    }
+
+    /* node is private with at most one child: splice it out */
+    *link = node->left_node!=HY_NULL ? node->left_node : node->right_node;
+    color = node->color;
+    tree->free_node( node,tree->alloc_arg );
+    tree->node_count--;
+
+    if( color==HYRBTREE_NODE_BLACK ){
+        hyrbtree_persist_del_balance( tree,path,dir,depth-1 );
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Capture the current version
+ * @param tree Persistent tree
+ * @param snap [out] Snapshot handle
+ *
+ * O(1): takes one reference on the root. Serialize with writes.
+ */
+void hyrbtree_persist_snapshot( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap ){
+    snap->root_node = tree->root_node;
+    snap->node_count = tree->node_count;
+    hyrbtree_persist_hold( snap->root_node );
+}
+
+/**
+ * @brief Release a snapshot
+ * @param tree Persistent tree
+ * @param snap Snapshot handle
+ *
+ * Frees the nodes no other version shares. May run concurrently with
+ * writes.
+ */
+void hyrbtree_persist_release( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap ){
+    hyrbtree_persist_put( tree,snap->root_node );
+    snap->root_node = HY_NULL;
+    snap->node_count = 0;
+}
+
+/**
+ * @brief Find user data by key
+ * @param tree Persistent tree
+ * @param snap Snapshot, HY_NULL for the current version
+ * @param elem Key to search
+ * @param get_node [out] Found user data
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Found
+ * - HYRBTREE_RET_GET_NODE_NOT_FIND: Key not present
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty version
+ */
+hyrbtree_ret_t hyrbtree_persist_get_node( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap,
+    void *elem,void **get_node ){
+
+    hyrbtree_pnode_t *root_node;
+    hyrbtree_pnode_t *node;
+
+    root_node = snap!=HY_NULL ? snap->root_node : tree->root_node;
+    if( root_node==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    node = hyrbtree_persist_find( tree,root_node,elem );
+    if( node==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_NOT_FIND;
+    }
+    *get_node = node->user_node;
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Visit all user data with keys in [lo_elem,hi_elem] in order
+ * @param tree Persistent tree
+ * @param snap Snapshot, HY_NULL for the current version
+ * @param lo_elem Lower key (inclusive), HY_NULL for no lower limit
+ * @param hi_elem Upper key (inclusive), HY_NULL for no upper limit
+ * @param visit Callback, returns non-zero to stop the scan
+ * @param arg User argument passed to visit
+ * @return Operation status code
+ *
+ * A snapshot scan sees a fixed version however long it runs.
+ * Returns:
+ * - HYRBTREE_RET_OK: Scan finished or stopped by visit
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: Empty version
+ */
+hyrbtree_ret_t hyrbtree_persist_range_scan( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap,
+    void *lo_elem,void *hi_elem,hyrbtree_visit_t visit,void *arg ){
+
+    hyrbtree_pnode_t *stack[HYRBTREE_PERSIST_MAX_DEPTH];
+    hyrbtree_pnode_t *node;
+    hy_u32_t stack_num;
+
+    node = snap!=HY_NULL ? snap->root_node : tree->root_node;
+    if( node==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+
+    /* Stack the ancestors at or above lo_elem on the way down */
+    stack_num = 0;
+    while( node!=HY_NULL ){
+        if( lo_elem!=HY_NULL && tree->cmp_elem( hyrbtree_persist_elem(tree,node),lo_elem )<0 ){
+            node = node->right_node;
+        }
+        else{
+            stack[ stack_num++ ] = node;
+            node = node->left_node;
+        }
+    }
+
+    while( stack_num!=0 ){
+        node = stack[ --stack_num ];
+        if( hi_elem!=HY_NULL && tree->cmp_elem( hyrbtree_persist_elem(tree,node),hi_elem )>0 ){
+            break;
+        }
+        if( visit( node->user_node,arg )!=0 ){
+            break;
+        }
+        for( node=node->right_node;node!=HY_NULL;node=node->left_node ){
+            stack[ stack_num++ ] = node;
+        }
+    }
+    return HYRBTREE_RET_OK;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file hyrbtree_persist.h
+ * @brief Persistent (Path-Copying) Red-Black Tree
+ *
+ * Copy-on-write variant for point-in-time views while writes continue:
+ * - Add/del copy only the O(log n) nodes they touch, untouched subtrees
+ *   are shared between versions
+ * - A snapshot is an O(1) reference on the current root
+ * - Nodes are reference counted and freed when the last version holding
+ *   them is released
+ *
+ * Nodes have no parent pointers (a shared subtree has one parent per
+ * version) and are allocated through caller callbacks. User data is
+ * referenced, not embedded: keep it valid and its key unchanged while
+ * any version that contains it is alive.
+ *
+ * Writes and hyrbtree_persist_snapshot must be serialized by the caller.
+ * Snapshots may be read and released from other threads concurrently with
+ * writes; free_node must then be thread-safe. Requires GCC/Clang __atomic
+ * builtins.
+ */
+
+#ifndef HYRBTREE_PERSIST_H
+#define HYRBTREE_PERSIST_H
+
+#include "hyrbtree.h"
+
+
+
+/* Path stack depth (red-black height is below 2*log2(n+1) <= 64 for 32-bit counts) */
+#define HYRBTREE_PERSIST_MAX_DEPTH      72
+
+
+
+/**
+ * @brief Persistent tree node (allocated by the tree)
+ */
+typedef struct hyrbtree_pnode_t{
+    struct hyrbtree_pnode_t *left_node;     ///< Left child, HY_NULL for none
+    struct hyrbtree_pnode_t *right_node;    ///< Right child, HY_NULL for none
+    void *user_node;                        ///< Referenced user data
+    hy_u32_t ref_count;                     ///< Parent links and root handles holding this node
+    hy_u8_t color;                          ///< HYRBTREE_NODE_RED or _BLACK
+}hyrbtree_pnode_t;
+
+/**
+ * @brief Point-in-time view
+ */
+typedef struct{
+    hyrbtree_pnode_t *root_node;    ///< Captured root (holds one reference)
+    hy_u32_t node_count;            ///< Nodes in the view
+}hyrbtree_persist_snap_t;
+
+/**
+ * @brief Persistent tree
+ *
+ * Fill cmp_elem, get_elem or elem_offset, alloc_node, free_node and
+ * alloc_arg, then call hyrbtree_persist_init.
+ */
+typedef struct{
+    /**
+     * @brief Callback to get the comparison key of user data
+     * @param user_node User data
+     * @return Pointer to comparable key
+     *
+     * HY_NULL to use elem_offset instead.
+     */
+    void* (*get_elem)(void *user_node);
+
+    /**
+     * @brief Element comparison callback (see hyrbtree_t)
+     */
+    hy_i32_t (*cmp_elem)(void *elem1,void *elem2);
+
+    /**
+     * @brief Allocate one hyrbtree_pnode_t
+     * @param arg alloc_arg
+     * @return Node memory, HY_NULL on failure
+     */
+    hyrbtree_pnode_t* (*alloc_node)(void *arg);
+
+    /**
+     * @brief Return a node obtained from alloc_node
+     * @param node Node memory
+     * @param arg alloc_arg
+     */
+    void (*free_node)(hyrbtree_pnode_t *node,void *arg);
+
+    void *alloc_arg;                ///< User argument for the allocator callbacks
+    hy_u32_t elem_offset;           ///< Key offset inside user data (get_elem==HY_NULL)
+
+    hyrbtree_pnode_t *root_node;    ///< Current version (holds one reference)
+    hy_u32_t node_count;            ///< Nodes in the current version
+    hyrbtree_pnode_t *spare_node;   ///< Preallocated nodes, linked through left_node
+    hy_u32_t spare_num;             ///< Entries in spare_node
+}hyrbtree_persist_t;
+
+
+
+/* Persistent Tree API */
+void hyrbtree_persist_init( hyrbtree_persist_t *tree );
+void hyrbtree_persist_clear( hyrbtree_persist_t *tree );
+hyrbtree_ret_t hyrbtree_persist_add_node( hyrbtree_persist_t *tree,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_persist_del_node( hyrbtree_persist_t *tree,void *elem,void **del_node );
+
+/* Versions */
+void hyrbtree_persist_snapshot( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap );
+void hyrbtree_persist_release( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap );
+
+/* Lookups (snap==HY_NULL reads the current version) */
+hyrbtree_ret_t hyrbtree_persist_get_node( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap,
+    void *elem,void **get_node );
+hyrbtree_ret_t hyrbtree_persist_range_scan( hyrbtree_persist_t *tree,hyrbtree_persist_snap_t *snap,
+    void *lo_elem,void *hi_elem,hyrbtree_visit_t visit,void *arg );
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file hyrbtree_shard.h
+ * @brief Sharded Red-Black Tree Container
+ *
+ * Splits the key space across independent hyrbtree_sync_t shards, each
+ * with its own writer lock:
+ * - Pluggable routing by key range or by hash of a 64-bit route key
+ * - Unified add/del/get, lock-free lookups inside a shard
+ * - Ordered scans across shards
+ * - Online split of a hot range shard at its median
+ *
+ * Routing is guarded by its own sequence counter, so operations racing a
+ * split are re-routed.
+ */
+
+#ifndef HYRBTREE_SHARD_H
+#define HYRBTREE_SHARD_H
+
+#include "hyrbtree_sync.h"
+
+
+
+/* Upper bound on shards per container */
+#ifndef HYRBTREE_CFG_SHARD_MAX
+#define HYRBTREE_CFG_SHARD_MAX          16
+#endif
+
+/* Routing modes */
+enum{
+    HYRBTREE_SHARD_ROUTE_RANGE,     ///< Route key ranges, ordered and splittable
+    HYRBTREE_SHARD_ROUTE_HASH,      ///< route_key modulo shard count
+};
+
+
+
+/**
+ * @brief Sharded container
+ *
+ * Fill shards, shard_max, shard_num, route_mode and route_key (and, in
+ * range mode with shard_num > 1, route_bound[1..shard_num-1]), then call
+ * hyrbtree_shard_init with a template tree.
+ */
+typedef struct{
+    hyrbtree_sync_t *shards;    ///< Caller storage, shard_max entries
+    hy_u32_t shard_max;         ///< Entries in shards (<= HYRBTREE_CFG_SHARD_MAX)
+    hy_u32_t shard_num;         ///< Shards in use
+
+    hy_u8_t route_mode;         ///< HYRBTREE_SHARD_ROUTE_RANGE or _HASH
+
+    /**
+     * @brief Callback to project a key onto the routing space
+     * @param elem Key element
+     * @return Route key
+     *
+     * Range mode: must be order-preserving like get_elem_cache
+     * (HYRBTREE_ELEM_CACHE_INT/UINT fit). Hash mode: any hash.
+     */
+    hy_u64_t (*route_key)(void *elem);
+
+    hy_u32_t route_slot[HYRBTREE_CFG_SHARD_MAX];    ///< Shard index of each route position
+    hy_u64_t route_bound[HYRBTREE_CFG_SHARD_MAX];   ///< Range mode: lowest route key of each position
+    hy_u32_t route_seq;         ///< Routing sequence counter, odd during a split
+    hy_u32_t route_lock;        ///< Serializes splits and cross-shard scans
+}hyrbtree_shard_t;
+
+
+
+/* Sharded Container API */
+void hyrbtree_shard_init( hyrbtree_shard_t *shard,hyrbtree_t *tree_template );
+hyrbtree_ret_t hyrbtree_shard_add_node( hyrbtree_shard_t *shard,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_shard_del_node( hyrbtree_shard_t *shard,void *user_node );
+hyrbtree_ret_t hyrbtree_shard_get_node( hyrbtree_shard_t *shard,void *get_elem,void **get_node );
+hyrbtree_ret_t hyrbtree_shard_range_scan( hyrbtree_shard_t *shard,void *lo_elem,void *hi_elem,
+    hyrbtree_visit_t visit,void *arg );
+hyrbtree_ret_t hyrbtree_shard_split( hyrbtree_shard_t *shard,hy_u32_t position );
+hy_u32_t hyrbtree_shard_count( hyrbtree_shard_t *shard );
+
+#endif
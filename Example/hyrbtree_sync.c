@@ -0,0 +1,285 @@
+/**
+ * @file hyrbtree_sync.c
+ * @brief Single-Writer / Optimistic-Reader Red-Black Tree Implementation
+ *
+ * Readers only ever follow root_node/left_node/right_node from the root and
+ * stop on reaching nil_node before loading its links. The scratch values
+ * hyrbtree_replace_successor parks in nil_node, and any cycle a reader may
+ * observe mid-rotation, therefore cost at most a bounded, discarded attempt.
+ */
+
+#include "hyrbtree_sync.h"
+
+
+
+/**
+ * @brief Locate the container of an rbnode seen by a reader
+ * @param tree Tree structure
+ * @param node Reachable rbnode (never nil_node)
+ * @return Container structure, HY_NULL if the node is being unlinked
+ *
+ * Offset mode never touches user_node, which a concurrent delete clears.
+ */
+static inline void *hyrbtree_sync_rbnode_to_user( hyrbtree_t *tree,hyrbnode_t *node ){
+    if( tree->get_rbnode!=HY_NULL ){
+        return (void *)((hy_uptr_t)__atomic_load_n(&node->user_node,__ATOMIC_RELAXED) & ~(hy_uptr_t)(0x1));
+    }
+    return (void *)((hy_u8_t *)node-tree->rbnode_offset);
+}
+
+/**
+ * @brief One optimistic descent
+ * @param tree Tree structure
+ * @param get_elem Key element
+ * @param elem_cache Cached prefix of get_elem
+ * @param get_node [out] Found node
+ * @param ret [out] Result of the descent
+ * @return 1 if the descent completed, 0 if it hit a torn state
+ *
+ * The caller validates the result against the sequence counter.
+ */
+static hy_u8_t hyrbtree_sync_try_get( hyrbtree_t *tree,void *get_elem,hy_u64_t elem_cache,
+    void **get_node,hyrbtree_ret_t *ret ){
+
+    hyrbnode_t *cur_node;
+    void *user_node;
+    void *node_elem;
+    hy_i32_t result;
+    hy_u32_t depth;
+
+    cur_node = __atomic_load_n(&tree->root_node,__ATOMIC_RELAXED);
+    if( cur_node==&tree->nil_node ){
+        *ret = HYRBTREE_RET_GET_NODE_TREE_NULL;
+        return 1;
+    }
+
+    *ret = HYRBTREE_RET_GET_NODE_NOT_FIND;
+    for( depth=0;depth<HYRBTREE_CFG_SYNC_MAX_DEPTH;depth++ ){
+        if( cur_node==&tree->nil_node ){
+            return 1;
+        }
+        user_node = hyrbtree_sync_rbnode_to_user(tree,cur_node);
+        if( user_node==HY_NULL ){
+            return 0;
+        }
+
+        result = 0;
+#if HYRBTREE_CFG_KEY_CACHE
+        if( tree->get_elem_cache!=HY_NULL ){
+            if( elem_cache<cur_node->elem_cache ){
+                result = -1;
+            }
+            else if( elem_cache>cur_node->elem_cache ){
+                result = 1;
+            }
+        }
+#endif
+        (void)elem_cache;
+        if( result==0 ){
+            if( tree->get_elem!=HY_NULL ){
+                node_elem = tree->get_elem(user_node);
+            }
+            else{
+                node_elem = (void *)((hy_u8_t *)user_node+tree->elem_offset);
+            }
+            result = tree->cmp_elem(get_elem,node_elem);
+        }
+
+        if( result==0 ){
+            *get_node = user_node;
+            *ret = HYRBTREE_RET_OK;
+            if( tree->multi_elem==0 ){
+                return 1;
+            }
+            /* Multimap: keep looking left for the first duplicate */
+            result = -1;
+        }
+        if( result<0 ){
+            cur_node = __atomic_load_n(&cur_node->left_node,__ATOMIC_RELAXED);
+        }
+        else{
+            cur_node = __atomic_load_n(&cur_node->right_node,__ATOMIC_RELAXED);
+        }
+    }
+    return 0;
+}
+
+
+
+/**
+ * @brief Initialize a concurrent tree
+ * @param sync Concurrent tree (tree callbacks/offsets already set)
+ */
+void hyrbtree_sync_init( hyrbtree_sync_t *sync ){
+    hyrbtree_init( &sync->tree );
+    sync->seq = 0;
+    sync->lock = 0;
+}
+
+/**
+ * @brief Begin an exclusive read section
+ * @param sync Concurrent tree
+ *
+ * Takes the writer spinlock without touching the sequence counter, so
+ * optimistic readers keep running. The tree must not be modified until
+ * hyrbtree_sync_unlock; use it for scans that need a stable tree.
+ */
+void hyrbtree_sync_lock( hyrbtree_sync_t *sync ){
+    while( __atomic_exchange_n(&sync->lock,1,__ATOMIC_ACQUIRE)!=0 ){
+        while( __atomic_load_n(&sync->lock,__ATOMIC_RELAXED)!=0 ){
+            HY_CPU_RELAX();
+        }
+    }
+}
+
+/**
+ * @brief End an exclusive read section
+ * @param sync Concurrent tree
+ */
+void hyrbtree_sync_unlock( hyrbtree_sync_t *sync ){
+    __atomic_store_n(&sync->lock,0,__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Begin a write section
+ * @param sync Concurrent tree
+ *
+ * Serializes against other writers and makes the sequence counter odd,
+ * which sends concurrent readers to retry. Any hyrbtree_* mutation may be
+ * applied to sync->tree until hyrbtree_sync_write_unlock.
+ */
+void hyrbtree_sync_write_lock( hyrbtree_sync_t *sync ){
+    hyrbtree_sync_lock( sync );
+    __atomic_store_n(&sync->seq,sync->seq+1,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Try to begin a write section without spinning
+ * @param sync Concurrent tree
+ * @return Non-zero if the write section was entered
+ */
+hy_u8_t hyrbtree_sync_try_write_lock( hyrbtree_sync_t *sync ){
+    if( __atomic_load_n(&sync->lock,__ATOMIC_RELAXED)!=0 ||
+        __atomic_exchange_n(&sync->lock,1,__ATOMIC_ACQUIRE)!=0 ){
+        return 0;
+    }
+    __atomic_store_n(&sync->seq,sync->seq+1,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * @brief End a write section
+ * @param sync Concurrent tree
+ */
+void hyrbtree_sync_write_unlock( hyrbtree_sync_t *sync ){
+    __atomic_store_n(&sync->seq,sync->seq+1,__ATOMIC_RELEASE);
+    hyrbtree_sync_unlock( sync );
+}
+
+/**
+ * @brief Insert a node under the write lock
+ * @param sync Concurrent tree
+ * @param user_node User data containing embedded rbnode
+ * @param exist_node [out] Returns existing node if key exists
+ * @return Operation status code (see hyrbtree_add_node)
+ */
+hyrbtree_ret_t hyrbtree_sync_add_node( hyrbtree_sync_t *sync,void *user_node,void **exist_node ){
+    hyrbtree_ret_t ret;
+
+    hyrbtree_sync_write_lock( sync );
+    ret = hyrbtree_add_node( &sync->tree,user_node,exist_node );
+    hyrbtree_sync_write_unlock( sync );
+    return ret;
+}
+
+/**
+ * @brief Remove a node under the write lock
+ * @param sync Concurrent tree
+ * @param user_node Node to delete
+ * @return Operation status code (see hyrbtree_del_node)
+ *
+ * Readers may still hold user_node; keep it readable until they drain.
+ */
+hyrbtree_ret_t hyrbtree_sync_del_node( hyrbtree_sync_t *sync,void *user_node ){
+    hyrbtree_ret_t ret;
+
+    hyrbtree_sync_write_lock( sync );
+    ret = hyrbtree_del_node( &sync->tree,user_node );
+    hyrbtree_sync_write_unlock( sync );
+    return ret;
+}
+
+
+
+/**
+ * @brief Begin an optimistic read section
+ * @param sync Concurrent tree
+ * @return Sequence snapshot for hyrbtree_sync_read_retry
+ *
+ * Waits out a write in progress. Between begin and retry, read tree links
+ * with __atomic_load_n and treat everything seen as provisional.
+ */
+hy_u32_t hyrbtree_sync_read_begin( hyrbtree_sync_t *sync ){
+    hy_u32_t seq;
+
+    while( ((seq=__atomic_load_n(&sync->seq,__ATOMIC_ACQUIRE)) & 0x1)!=0 ){
+        HY_CPU_RELAX();
+    }
+    return seq;
+}
+
+/**
+ * @brief Check whether an optimistic read section must be repeated
+ * @param sync Concurrent tree
+ * @param seq Value returned by hyrbtree_sync_read_begin
+ * @return Non-zero if a writer ran meanwhile (results are invalid)
+ */
+hy_u8_t hyrbtree_sync_read_retry( hyrbtree_sync_t *sync,hy_u32_t seq ){
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&sync->seq,__ATOMIC_RELAXED)!=seq;
+}
+
+/**
+ * @brief Find a node without taking the lock
+ * @param sync Concurrent tree
+ * @param get_elem Key to search
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_get_node)
+ *
+ * Retries up to HYRBTREE_CFG_SYNC_RETRIES optimistic descents, then falls
+ * back to a locked lookup so readers cannot starve under write storms.
+ */
+hyrbtree_ret_t hyrbtree_sync_get_node( hyrbtree_sync_t *sync,void *get_elem,void **get_node ){
+    hyrbtree_t *tree;
+    hyrbtree_ret_t ret;
+    void *found_node;
+    hy_u64_t elem_cache;
+    hy_u32_t seq;
+    hy_u32_t retry;
+
+    tree = &sync->tree;
+    elem_cache = 0;
+#if HYRBTREE_CFG_KEY_CACHE
+    if( tree->get_elem_cache!=HY_NULL ){
+        elem_cache = tree->get_elem_cache(get_elem);
+    }
+#endif
+
+    for( retry=0;retry<HYRBTREE_CFG_SYNC_RETRIES;retry++ ){
+        seq = hyrbtree_sync_read_begin( sync );
+        if( hyrbtree_sync_try_get( tree,get_elem,elem_cache,&found_node,&ret )!=0 &&
+            hyrbtree_sync_read_retry( sync,seq )==0 ){
+            if( ret==HYRBTREE_RET_OK ){
+                *get_node = found_node;
+            }
+            return ret;
+        }
+    }
+
+    hyrbtree_sync_lock( sync );
+    ret = hyrbtree_get_node( tree,get_elem,get_node );
+    hyrbtree_sync_unlock( sync );
+    return ret;
+}
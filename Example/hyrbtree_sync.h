@@ -0,0 +1,76 @@
+/**
+ * @file hyrbtree_sync.h
+ * @brief Single-Writer / Optimistic-Reader Red-Black Tree
+ *
+ * Wraps hyrbtree_t with a writer spinlock and a sequence counter:
+ * - Writers serialize on the lock and make the counter odd while mutating
+ * - Readers descend without locks or shared stores and retry if the
+ *   counter moved, falling back to the lock after repeated failures
+ *
+ * Requires GCC/Clang __atomic builtins. Nodes removed from the tree may
+ * still be read by in-flight readers: keep their memory (and key) readable
+ * until readers have drained, e.g. by using type-stable pools. cmp_elem may
+ * see a key that is being rewritten; its result is discarded, but it must
+ * not fault on such a key.
+ *
+ * Writers go through the plain hyrbtree_* code, so the link, root_node and
+ * user_node stores the readers follow are ordinary stores, as is the
+ * elem_cache field readers compare without an atomic load. The design
+ * relies on aligned pointer-sized (and, with HYRBTREE_CFG_KEY_CACHE, 64-bit)
+ * stores not tearing on the target; any value a reader sees is discarded
+ * if the sequence counter moved. These are data races in the C11 sense:
+ * the module is not ThreadSanitizer-clean, so suppress hyrbtree_sync_try_get
+ * when running under TSan.
+ */
+
+#ifndef HYRBTREE_SYNC_H
+#define HYRBTREE_SYNC_H
+
+#include "hyrbtree.h"
+
+
+
+/* Optimistic read attempts before hyrbtree_sync_get_node takes the lock */
+#ifndef HYRBTREE_CFG_SYNC_RETRIES
+#define HYRBTREE_CFG_SYNC_RETRIES       8
+#endif
+
+/* Descent step limit for optimistic reads (tree height is below 64 for 32-bit counts) */
+#ifndef HYRBTREE_CFG_SYNC_MAX_DEPTH
+#define HYRBTREE_CFG_SYNC_MAX_DEPTH     64
+#endif
+
+
+
+/**
+ * @brief Concurrent tree handle
+ *
+ * Fill tree's callbacks/offsets as for hyrbtree_init, then call
+ * hyrbtree_sync_init.
+ */
+typedef struct{
+    hyrbtree_t tree;            ///< Underlying tree (mutate only under the write lock)
+    hy_u32_t seq;               ///< Sequence counter, odd while a write is in progress
+    hy_u32_t lock;              ///< Writer spinlock
+}hyrbtree_sync_t;
+
+
+
+/* Setup */
+void hyrbtree_sync_init( hyrbtree_sync_t *sync );
+
+/* Writer Side */
+void hyrbtree_sync_lock( hyrbtree_sync_t *sync );
+void hyrbtree_sync_unlock( hyrbtree_sync_t *sync );
+void hyrbtree_sync_write_lock( hyrbtree_sync_t *sync );
+hy_u8_t hyrbtree_sync_try_write_lock( hyrbtree_sync_t *sync );
+void hyrbtree_sync_write_unlock( hyrbtree_sync_t *sync );
+hyrbtree_ret_t hyrbtree_sync_add_node( hyrbtree_sync_t *sync,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_sync_del_node( hyrbtree_sync_t *sync,void *user_node );
+
+/* Reader Side */
+hy_u32_t hyrbtree_sync_read_begin( hyrbtree_sync_t *sync );
+hy_u8_t hyrbtree_sync_read_retry( hyrbtree_sync_t *sync,hy_u32_t seq );
+hyrbtree_ret_t hyrbtree_sync_get_node( hyrbtree_sync_t *sync,void *get_elem,void **get_node );
+
+#endif
@@ -289,12 +289,1746 @@ hy_i32_t user_node_cmp_elem( void *elem1,void *elem2 ){
     return 0;
 }
 
+/**
+ * @brief Allocate and insert one node per element
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Duplicate elements are returned to the pool.
+ */
+void user_tree_fill( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            if( hyrbtree_add_node( rbtree,new_node_ptr,(void **)&exist_node_ptr )!=HYRBTREE_RET_OK ){
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+}
+
+/**
+ * @brief Remove every node and release it to the pool
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test
+ */
+void user_tree_clear( user_pool_t *user_pool,hyrbtree_t *rbtree ){
+    user_node_t *cur_node_ptr;
+
+    while( (cur_node_ptr=hyrbtree_first(rbtree))!=NULL ){
+        hyrbtree_del_node( rbtree,cur_node_ptr );
+        user_pool_del_node( user_pool,cur_node_ptr );
+    }
+}
+
+/**
+ * @brief Iterator test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates:
+ * 1. Forward walk with hyrbtree_first/hyrbtree_next
+ * 2. Backward walk with hyrbtree_last/hyrbtree_prev
+ * 3. Deletion while iterating
+ */
+void hyrbtree_iter_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size ){
+
+    user_node_t *cur_node_ptr;
+    user_node_t *next_node_ptr;
+
+    user_tree_fill( user_pool,rbtree,add_array,add_array_size );
+
+    printf("\n\niter forward:");
+    for( cur_node_ptr=hyrbtree_first(rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(rbtree,cur_node_ptr) ){
+        printf(" %d",cur_node_ptr->elem);
+    }
+    printf("\niter backward:");
+    for( cur_node_ptr=hyrbtree_last(rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_prev(rbtree,cur_node_ptr) ){
+        printf(" %d",cur_node_ptr->elem);
+    }
+
+    printf("\niter delete:");
+    cur_node_ptr = hyrbtree_first(rbtree);
+    while( cur_node_ptr!=NULL ){
+        next_node_ptr = hyrbtree_next(rbtree,cur_node_ptr);
+        printf(" %d",cur_node_ptr->elem);
+        hyrbtree_del_node( rbtree,cur_node_ptr );
+        user_pool_del_node( user_pool,cur_node_ptr );
+        cur_node_ptr = next_node_ptr;
+    }
+    if( hyrbtree_first(rbtree)==NULL && hyrbtree_last(rbtree)==NULL ){
+        printf("\ntree empty!");
+    }
+}
+
+/**
+ * @brief Scan callback: print visited element
+ * @param user_node Visited node
+ * @param arg Unused
+ * @return 0 to continue the scan
+ */
+hy_u8_t user_node_print_visit( void *user_node,void *arg ){
+    (void)arg;
+    printf(" %d",((user_node_t *)user_node)->elem);
+    return 0;
+}
+
+/**
+ * @brief Ordered search test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param query_array Keys to query
+ * @param query_array_size Query count
+ * 
+ * Validates lower_bound/upper_bound/floor/ceiling for every query key,
+ * batched lookup of all query keys, range scans between consecutive
+ * query keys, an inverted range and an unbounded one.
+ */
+void hyrbtree_bound_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size,
+    int32_t *query_array,uint32_t query_array_size ){
+
+    uint8_t i;
+    user_node_t *ret_node_ptr;
+
+    user_tree_fill( user_pool,rbtree,add_array,add_array_size );
+
+    printf("\n\nbound search:");
+    for( i=0;i<query_array_size;i++ ){
+        printf("\nelem=%d",query_array[i]);
+        if( hyrbtree_lower_bound( rbtree,&query_array[i],(void **)&ret_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" lower=%d",ret_node_ptr->elem);
+        }
+        else{
+            printf(" lower=none");
+        }
+        if( hyrbtree_upper_bound( rbtree,&query_array[i],(void **)&ret_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" upper=%d",ret_node_ptr->elem);
+        }
+        else{
+            printf(" upper=none");
+        }
+        if( hyrbtree_floor( rbtree,&query_array[i],(void **)&ret_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" floor=%d",ret_node_ptr->elem);
+        }
+        else{
+            printf(" floor=none");
+        }
+        if( hyrbtree_ceiling( rbtree,&query_array[i],(void **)&ret_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" ceiling=%d",ret_node_ptr->elem);
+        }
+        else{
+            printf(" ceiling=none");
+        }
+    }
+
+    void *query_ptrs[USER_POOL_SIZE];
+    void *get_nodes[USER_POOL_SIZE];
+
+    printf("\n\nbatch get:");
+    for( i=0;i<query_array_size;i++ ){
+        query_ptrs[i] = &query_array[i];
+    }
+    if( hyrbtree_get_nodes( rbtree,query_ptrs,query_array_size,get_nodes )==HYRBTREE_RET_OK ){
+        for( i=0;i<query_array_size;i++ ){
+            if( get_nodes[i]!=NULL ){
+                printf(" %d:found",query_array[i]);
+            }
+            else{
+                printf(" %d:none",query_array[i]);
+            }
+        }
+    }
+
+    printf("\n\nrange scan:");
+    for( i=1;i<query_array_size;i++ ){
+        printf("\n[%d,%d]:",query_array[i-1],query_array[i]);
+        hyrbtree_range_scan( rbtree,&query_array[i-1],&query_array[i],user_node_print_visit,NULL );
+    }
+    printf("\n[-,%d]:",query_array[0]);
+    hyrbtree_range_scan( rbtree,NULL,&query_array[0],user_node_print_visit,NULL );
+    printf("\n[%d,%d]:",query_array[query_array_size-2],query_array[1]);
+    hyrbtree_range_scan( rbtree,&query_array[query_array_size-2],&query_array[1],user_node_print_visit,NULL );
+    printf("\n[-,-]:");
+    hyrbtree_range_scan( rbtree,NULL,NULL,user_node_print_visit,NULL );
+
+    user_tree_clear( user_pool,rbtree );
+}
+
+/**
+ * @brief Bulk build test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param sorted_array Elements in increasing order
+ * @param sorted_array_size Element count
+ * 
+ * Validates that hyrbtree_build_sorted links a balanced, correctly colored
+ * tree and refuses to build into a non-empty tree.
+ */
+void hyrbtree_build_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *sorted_array,uint32_t sorted_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    void *build_nodes[USER_POOL_SIZE];
+    uint32_t build_num;
+
+    build_num = 0;
+    for( i=0;i<sorted_array_size;i++ ){
+        new_node.elem = sorted_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            build_nodes[ build_num++ ] = new_node_ptr;
+        }
+    }
+
+    printf("\n\nbuild sorted:");
+    ret = hyrbtree_build_sorted( rbtree,build_nodes,build_num );
+    if( ret==HYRBTREE_RET_OK ){
+        printf(" success!");
+        rbtree_preorder( rbtree,rbtree->root_node,0 );
+    }
+    ret = hyrbtree_build_sorted( rbtree,build_nodes,build_num );
+    if( ret==HYRBTREE_RET_BUILD_TREE_NOT_EMPTY ){
+        printf("\nbuild again: tree not empty!");
+    }
+
+    user_tree_clear( user_pool,rbtree );
+}
+
+/**
+ * @brief Batch insert test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param add_array Elements to insert, unsorted with duplicates
+ * @param add_array_size Insertion count
+ * 
+ * Validates sorting, finger descent and per-element collision reports of
+ * hyrbtree_add_nodes.
+ */
+void hyrbtree_batch_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    void *batch_nodes[USER_POOL_SIZE];
+    void *exist_nodes[USER_POOL_SIZE];
+    uint32_t batch_num;
+
+    batch_num = 0;
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            batch_nodes[ batch_num++ ] = new_node_ptr;
+        }
+    }
+
+    printf("\n\nbatch add:");
+    if( hyrbtree_add_nodes( rbtree,batch_nodes,batch_num,exist_nodes,1 )==HYRBTREE_RET_OK ){
+        for( i=0;i<batch_num;i++ ){
+            printf("\nelem=%d,addr=%d",((user_node_t *)batch_nodes[i])->elem,((user_node_t *)batch_nodes[i])->addr);
+            if( exist_nodes[i]==NULL ){
+                printf(" success!");
+            }
+            else{
+                printf(" exist! addr=%d",((user_node_t *)exist_nodes[i])->addr);
+                user_pool_del_node( user_pool,batch_nodes[i] );
+            }
+        }
+    }
+    printf("\n\nrbtree_preorder:");
+    rbtree_preorder( rbtree,rbtree->root_node,0 );
+
+    user_tree_clear( user_pool,rbtree );
+}
+
+/**
+ * @brief Hinted insert/lookup test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param add_array Elements to append, mostly increasing
+ * @param add_array_size Insertion count
+ * 
+ * Each element is inserted with the previously inserted node as hint, then
+ * looked up again with the first node as hint.
+ */
+void hyrbtree_hint_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *hint_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *ret_node_ptr;
+
+    printf("\n\nhint add node:");
+    hint_node_ptr = NULL;
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            printf("\nAdd node elem=%d",new_node.elem);
+            ret = hyrbtree_add_node_hint( rbtree,hint_node_ptr,new_node_ptr,(void **)&exist_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" success!");
+                hint_node_ptr = new_node_ptr;
+            }
+            else if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                printf(" exist! addr=%d",exist_node_ptr->addr);
+                user_pool_del_node( user_pool,new_node_ptr );
+                hint_node_ptr = exist_node_ptr;
+            }
+        }
+    }
+    printf("\n\nrbtree_preorder:");
+    rbtree_preorder( rbtree,rbtree->root_node,0 );
+
+    printf("\n\nhint get node:");
+    for( i=0;i<add_array_size;i++ ){
+        hint_node_ptr = hyrbtree_first(rbtree);
+        ret = hyrbtree_get_node_hint( rbtree,hint_node_ptr,&add_array[i],(void **)&ret_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d:addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+        }
+    }
+
+    user_tree_clear( user_pool,rbtree );
+}
+
+/**
+ * @brief Order statistic test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty)
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param query_array Keys to rank
+ * @param query_array_size Query count
+ *
+ * Validates hyrbtree_count across insert/delete and, when built with
+ * HYRBTREE_CFG_SUBTREE_SIZE, select by rank and rank by key.
+ */
+void hyrbtree_order_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size,
+    int32_t *query_array,uint32_t query_array_size ){
+
+    user_node_t *cur_node_ptr;
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hy_u32_t rank;
+#endif
+
+    user_tree_fill( user_pool,rbtree,add_array,add_array_size );
+    printf("\n\nnode count=%u",hyrbtree_count(rbtree));
+
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    printf("\nselect:");
+    for( i=0;i<=hyrbtree_count(rbtree);i++ ){
+        ret = hyrbtree_select( rbtree,i,(void **)&cur_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d:%d",i,cur_node_ptr->elem);
+        }
+        else{
+            printf(" %d:not find!",i);
+        }
+    }
+
+    printf("\nrank:");
+    for( i=0;i<query_array_size;i++ ){
+        ret = hyrbtree_rank( rbtree,&query_array[i],&rank );
+        printf(" %d:%u%s",query_array[i],rank,ret==HYRBTREE_RET_OK ? "" : "(absent)");
+    }
+#else
+    (void)query_array;
+    (void)query_array_size;
+#endif
+
+    cur_node_ptr = hyrbtree_first(rbtree);
+    if( cur_node_ptr!=NULL && hyrbtree_del_node( rbtree,cur_node_ptr )==HYRBTREE_RET_OK ){
+        user_pool_del_node( user_pool,cur_node_ptr );
+    }
+    printf("\ndel first, node count=%u",hyrbtree_count(rbtree));
+
+    user_tree_clear( user_pool,rbtree );
+    printf("\nclear, node count=%u",hyrbtree_count(rbtree));
+}
+
+/**
+ * @brief Callback: Recompute elem_sum from the children
+ * @param node Container structure
+ * @param left_node Left child container or HY_NULL
+ * @param right_node Right child container or HY_NULL
+ * @return 1 if elem_sum changed
+ */
+hy_u8_t user_node_augment( void *node,void *left_node,void *right_node ){
+    int32_t elem_sum;
+
+    elem_sum = ((user_node_t *)node)->elem;
+    if( left_node!=HY_NULL ){
+        elem_sum += ((user_node_t *)left_node)->elem_sum;
+    }
+    if( right_node!=HY_NULL ){
+        elem_sum += ((user_node_t *)right_node)->elem_sum;
+    }
+    if( ((user_node_t *)node)->elem_sum==elem_sum ){
+        return 0;
+    }
+    ((user_node_t *)node)->elem_sum = elem_sum;
+    return 1;
+}
+
+/**
+ * @brief Callback: Accumulate one range aggregate contribution
+ * @param node Contributing container
+ * @param whole_subtree Take elem_sum instead of elem
+ * @param arg int32_t accumulator
+ */
+void user_node_collect_sum( void *node,hy_u8_t whole_subtree,void *arg ){
+    if( whole_subtree ){
+        *(int32_t *)arg += ((user_node_t *)node)->elem_sum;
+    }
+    else{
+        *(int32_t *)arg += ((user_node_t *)node)->elem;
+    }
+}
+
+/**
+ * @brief Augmented tree test sequence
+ * @param user_pool Memory manager
+ * @param rbtree Tree under test (empty, augment_node registered)
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param range_array Inclusive [lo,hi] pairs to sum
+ * @param range_array_size Element count of range_array (2 per range)
+ * 
+ * Validates that elem_sum survives rebalancing on insert and delete and
+ * that hyrbtree_range_aggregate sums key ranges.
+ */
+void hyrbtree_augment_test( user_pool_t *user_pool,hyrbtree_t *rbtree,
+    int32_t *add_array,uint32_t add_array_size,
+    int32_t *range_array,uint32_t range_array_size ){
+
+    uint8_t i;
+    int32_t range_sum;
+    user_node_t *cur_node_ptr;
+
+    user_tree_fill( user_pool,rbtree,add_array,add_array_size );
+
+    printf("\n\nrange sum:");
+    for( i=1;i<range_array_size;i+=2 ){
+        range_sum = 0;
+        hyrbtree_range_aggregate( rbtree,&range_array[i-1],&range_array[i],user_node_collect_sum,&range_sum );
+        printf(" [%d,%d]=%d",range_array[i-1],range_array[i],range_sum);
+    }
+
+    for( i=0;i<add_array_size;i+=2 ){
+        if( hyrbtree_get_node( rbtree,&add_array[i],(void **)&cur_node_ptr )==HYRBTREE_RET_OK &&
+            hyrbtree_del_node( rbtree,cur_node_ptr )==HYRBTREE_RET_OK ){
+            user_pool_del_node( user_pool,cur_node_ptr );
+        }
+    }
+    cur_node_ptr = (user_node_t *)HYRBTREE_GET_NODE_ADDR(rbtree->root_node);
+    printf("\nafter del, root elem_sum=%d",cur_node_ptr!=HY_NULL ? cur_node_ptr->elem_sum : 0);
+
+    printf("\nrange sum:");
+    for( i=1;i<range_array_size;i+=2 ){
+        range_sum = 0;
+        hyrbtree_range_aggregate( rbtree,&range_array[i-1],&range_array[i],user_node_collect_sum,&range_sum );
+        printf(" [%d,%d]=%d",range_array[i-1],range_array[i],range_sum);
+    }
+
+    user_tree_clear( user_pool,rbtree );
+}
+
+/**
+ * @brief Callback: Print one overlapping interval
+ * @param node hyrbtree_interval_t embedded in user_range_t
+ * @param arg Unused
+ * @return 0 to continue
+ */
+hy_u8_t user_range_print_visit( void *node,void *arg ){
+    user_range_t *range_ptr;
+
+    (void)arg;
+    range_ptr = HYRBTREE_CONTAINER_OF(node,user_range_t,interval);
+    printf(" %d:[%llu,%llu]",range_ptr->addr,(unsigned long long)range_ptr->interval.start,(unsigned long long)range_ptr->interval.end);
+    return 0;
+}
+
+/**
+ * @brief Interval tree test sequence
+ * @param range_array Inclusive [start,end] pairs to insert
+ * @param range_array_size Element count of range_array (2 per interval)
+ * @param query_array Inclusive [lo,hi] pairs to query
+ * @param query_array_size Element count of query_array (2 per query)
+ * 
+ * Validates overlap enumeration, stabbing queries and equal starts, then
+ * removes every interval.
+ */
+void hyrbtree_interval_test( uint64_t *range_array,uint32_t range_array_size,
+    uint64_t *query_array,uint32_t query_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hyrbtree_t rbtree = {0};
+    user_range_t range_pool[USER_POOL_SIZE] = {0};
+    hyrbtree_interval_t *interval_ptr;
+
+    hyrbtree_interval_init( &rbtree );
+
+    printf("\n\ninterval add:");
+    for( i=1;i<range_array_size && i/2<USER_POOL_SIZE;i+=2 ){
+        range_pool[i/2].addr = i/2;
+        ret = hyrbtree_interval_add( &rbtree,&range_pool[i/2].interval,range_array[i-1],range_array[i] );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" [%llu,%llu]",(unsigned long long)range_array[i-1],(unsigned long long)range_array[i]);
+        }
+        else if( ret==HYRBTREE_RET_INTERVAL_RANGE_ERROR ){
+            printf(" [%llu,%llu]:range error!",(unsigned long long)range_array[i-1],(unsigned long long)range_array[i]);
+        }
+    }
+
+    for( i=1;i<query_array_size;i+=2 ){
+        printf("\noverlap [%llu,%llu]:",(unsigned long long)query_array[i-1],(unsigned long long)query_array[i]);
+        hyrbtree_interval_overlap( &rbtree,query_array[i-1],query_array[i],user_range_print_visit,HY_NULL );
+        ret = hyrbtree_interval_stab( &rbtree,query_array[i-1],&interval_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" stab %llu:",(unsigned long long)query_array[i-1]);
+            user_range_print_visit( interval_ptr,HY_NULL );
+        }
+        else{
+            printf(" stab %llu: not find!",(unsigned long long)query_array[i-1]);
+        }
+    }
+
+    while( (interval_ptr=hyrbtree_first(&rbtree))!=HY_NULL ){
+        hyrbtree_interval_del( &rbtree,interval_ptr );
+    }
+    printf("\ninterval clear, node count=%u",hyrbtree_count(&rbtree));
+}
+
+/**
+ * @brief Concurrent tree test sequence (single thread)
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates the locked writer path, optimistic lookups and the read
+ * section protocol (a write inside a read section forces a retry).
+ */
+void hyrbtree_sync_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hy_u32_t seq;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *ret_node_ptr;
+    hyrbtree_sync_t sync = {
+        .tree = {
+            HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+        },
+    };
+
+    hyrbtree_sync_init( &sync );
+
+    printf("\n\nsync add node:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = hyrbtree_sync_add_node( &sync,new_node_ptr,(void **)&exist_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" %d",new_node.elem);
+            }
+            else{
+                printf(" %d:exist!",new_node.elem);
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+
+    printf("\nsync get node:");
+    for( i=0;i<add_array_size;i++ ){
+        ret = hyrbtree_sync_get_node( &sync,&add_array[i],(void **)&ret_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d:addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+        }
+    }
+
+    seq = hyrbtree_sync_read_begin( &sync );
+    printf("\nread section idle: retry=%d",hyrbtree_sync_read_retry( &sync,seq ));
+    ret_node_ptr = hyrbtree_first( &sync.tree );
+    if( ret_node_ptr!=HY_NULL && hyrbtree_sync_del_node( &sync,ret_node_ptr )==HYRBTREE_RET_OK ){
+        user_pool_del_node( user_pool,ret_node_ptr );
+    }
+    printf("\nread section across del: retry=%d",hyrbtree_sync_read_retry( &sync,seq ));
+
+    hyrbtree_sync_write_lock( &sync );
+    user_tree_clear( user_pool,&sync.tree );
+    hyrbtree_sync_write_unlock( &sync );
+    ret = hyrbtree_sync_get_node( &sync,&add_array[0],(void **)&ret_node_ptr );
+    if( ret==HYRBTREE_RET_GET_NODE_TREE_NULL ){
+        printf("\nsync clear: tree null!");
+    }
+}
+
+/**
+ * @brief Callback: Project key onto the shard routing space
+ * @param elem Key element
+ * @return Order-preserving route key
+ */
+hy_u64_t user_node_route_key( void *elem ){
+    return HYRBTREE_ELEM_CACHE_INT(*(int32_t *)elem);
+}
+
+/**
+ * @brief Sharded container test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates routed insert/lookup, splitting a range shard at its median
+ * and ordered scans across shards.
+ */
+void hyrbtree_shard_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hy_u32_t position;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *ret_node_ptr;
+    hyrbtree_t tree_template = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+    };
+    hyrbtree_sync_t shard_store[4];
+    hyrbtree_shard_t shard = {
+        .shards = shard_store,
+        .shard_max = 4,
+        .shard_num = 1,
+        .route_mode = HYRBTREE_SHARD_ROUTE_RANGE,
+        .route_key = user_node_route_key,
+    };
+
+    hyrbtree_shard_init( &shard,&tree_template );
+
+    printf("\n\nshard add node:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = hyrbtree_shard_add_node( &shard,new_node_ptr,(void **)&exist_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" %d",new_node.elem);
+            }
+            else{
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+
+    for( i=0;i<3;i++ ){
+        ret = hyrbtree_shard_split( &shard,shard.shard_num-1 );
+        printf("\nsplit last shard:%s",ret==HYRBTREE_RET_OK ? " success!" : " failed!");
+        for( position=0;position<shard.shard_num;position++ ){
+            printf(" [%u]count=%u",position,hyrbtree_count( &shard.shards[ shard.route_slot[position] ].tree ));
+        }
+    }
+
+    printf("\nshard get node:");
+    for( i=0;i<add_array_size;i+=3 ){
+        ret = hyrbtree_shard_get_node( &shard,&add_array[i],(void **)&ret_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d:addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+        }
+    }
+
+    printf("\nshard range scan [%d,%d]:",add_array[1],add_array[0]);
+    hyrbtree_shard_range_scan( &shard,&add_array[1],&add_array[0],user_node_print_visit,HY_NULL );
+    printf("\nshard count=%u",hyrbtree_shard_count( &shard ));
+
+    for( position=0;position<shard.shard_num;position++ ){
+        user_tree_clear( user_pool,&shard.shards[ shard.route_slot[position] ].tree );
+    }
+}
+
+/**
+ * @brief Flat-combining tree test sequence (single thread)
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates that add/replace/del requests published through a slot are
+ * applied by the combiner and their results returned.
+ */
+void hyrbtree_fc_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *ret_node_ptr;
+    hyrbtree_fc_slot_t fc_slots[2];
+    hyrbtree_fc_t fc = {
+        .sync = {
+            .tree = {
+                HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+            },
+        },
+        .slots = fc_slots,
+        .slot_num = 2,
+    };
+
+    hyrbtree_fc_init( &fc );
+
+    printf("\n\nfc add node:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = hyrbtree_fc_add_node( &fc,0,new_node_ptr,(void **)&exist_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" %d",new_node.elem);
+            }
+            else if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                printf(" %d:exist! addr=%d",new_node.elem,exist_node_ptr->addr);
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+
+    printf("\nfc replace node:");
+    if( hyrbtree_fc_get_node( &fc,&add_array[0],(void **)&ret_node_ptr )==HYRBTREE_RET_OK ){
+        new_node.elem = add_array[0];
+        new_node.addr = add_array_size;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = hyrbtree_fc_replace_node( &fc,1,ret_node_ptr,new_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                user_pool_del_node( user_pool,ret_node_ptr );
+                printf(" %d:addr=%d",new_node_ptr->elem,new_node_ptr->addr);
+            }
+        }
+    }
+
+    printf("\nfc del node:");
+    for( i=1;i<add_array_size;i+=2 ){
+        if( hyrbtree_fc_get_node( &fc,&add_array[i],(void **)&ret_node_ptr )==HYRBTREE_RET_OK &&
+            hyrbtree_fc_del_node( &fc,1,ret_node_ptr )==HYRBTREE_RET_OK ){
+            user_pool_del_node( user_pool,ret_node_ptr );
+            printf(" %d",add_array[i]);
+        }
+    }
+
+    printf("\nfc remain:");
+    for( ret_node_ptr=hyrbtree_first(&fc.sync.tree);ret_node_ptr!=HY_NULL;ret_node_ptr=hyrbtree_next(&fc.sync.tree,ret_node_ptr) ){
+        printf(" %d:addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+    }
+
+    user_tree_clear( user_pool,&fc.sync.tree );
+}
+
+/**
+ * @brief Take a node from the persistent node pool
+ * @param arg user_pnode_pool_t
+ * @return Node, NULL when exhausted
+ */
+hyrbtree_pnode_t *user_pnode_alloc( void *arg ){
+    user_pnode_pool_t *pnode_pool = (user_pnode_pool_t *)arg;
+    hyrbtree_pnode_t *node;
+
+    node = pnode_pool->free_node;
+    if( node!=NULL ){
+        pnode_pool->free_node = node->left_node;
+        pnode_pool->used_num++;
+    }
+    return node;
+}
+
+/**
+ * @brief Return a node to the persistent node pool
+ * @param node Node from user_pnode_alloc
+ * @param arg user_pnode_pool_t
+ */
+void user_pnode_free( hyrbtree_pnode_t *node,void *arg ){
+    user_pnode_pool_t *pnode_pool = (user_pnode_pool_t *)arg;
+
+    node->left_node = pnode_pool->free_node;
+    pnode_pool->free_node = node;
+    pnode_pool->used_num--;
+}
+
+/**
+ * @brief Persistent tree test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates that a snapshot keeps its contents while the current version
+ * is modified, and that releasing it returns every node.
+ */
+void hyrbtree_persist_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+
+    uint32_t i;
+    uint32_t del_num;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *del_nodes[32];
+    static user_pnode_pool_t pnode_pool;
+    hyrbtree_persist_snap_t snap;
+    hyrbtree_persist_t ptree = {
+        .cmp_elem = user_node_cmp_elem,
+        .elem_offset = offsetof(user_node_t,elem),
+        .alloc_node = user_pnode_alloc,
+        .free_node = user_pnode_free,
+        .alloc_arg = &pnode_pool,
+    };
+
+    pnode_pool.free_node = NULL;
+    pnode_pool.used_num = 0;
+    for( i=0;i<sizeof(pnode_pool.nodes)/sizeof(pnode_pool.nodes[0]);i++ ){
+        user_pnode_free( &pnode_pool.nodes[i],&pnode_pool );
+        pnode_pool.used_num++;
+    }
+    hyrbtree_persist_init( &ptree );
+
+    printf("\n\npersist add node:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = hyrbtree_persist_add_node( &ptree,new_node_ptr,(void **)&exist_node_ptr );
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" %d",new_node.elem);
+            }
+            else{
+                if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                    printf(" %d:exist! addr=%d",new_node.elem,exist_node_ptr->addr);
+                }
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+
+    hyrbtree_persist_snapshot( &ptree,&snap );
+    printf("\npersist snapshot count=%u",snap.node_count);
+
+    printf("\npersist del node:");
+    del_num = 0;
+    for( i=0;i<add_array_size && del_num<32;i+=2 ){
+        if( hyrbtree_persist_del_node( &ptree,&add_array[i],(void **)&del_nodes[del_num] )==HYRBTREE_RET_OK ){
+            printf(" %d",add_array[i]);
+            del_num++;
+        }
+    }
+
+    printf("\npersist current:");
+    hyrbtree_persist_range_scan( &ptree,NULL,NULL,NULL,user_node_print_visit,NULL );
+    printf("\npersist snapshot:");
+    hyrbtree_persist_range_scan( &ptree,&snap,NULL,NULL,user_node_print_visit,NULL );
+
+    /* Deleted user nodes stay readable until the snapshot is released */
+    hyrbtree_persist_release( &ptree,&snap );
+    for( i=0;i<del_num;i++ ){
+        user_pool_del_node( user_pool,del_nodes[i] );
+    }
+
+    for( i=1;i<add_array_size;i+=2 ){
+        if( hyrbtree_persist_del_node( &ptree,&add_array[i],(void **)&new_node_ptr )==HYRBTREE_RET_OK ){
+            user_pool_del_node( user_pool,new_node_ptr );
+        }
+    }
+    hyrbtree_persist_clear( &ptree );
+    printf("\npersist nodes in use=%u",pnode_pool.used_num);
+}
+
+/**
+ * @brief Compact tree test sequence
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param seek_elem Key to position a cursor at
+ * 
+ * Validates insert/delete on the parent-free layout and cursor iteration
+ * in both directions.
+ */
+void hyrbtree_compact_test( int32_t *add_array,uint32_t add_array_size,int32_t seek_elem ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hyrbtree_compact_t ctree = {
+        HYRBTREE_OFFSET_INIT(user_cnode_t,cnode,elem,user_node_cmp_elem),
+    };
+    hyrbtree_compact_cursor_t cursor;
+    user_cnode_t cnode_pool[USER_POOL_SIZE] = {0};
+    user_cnode_t *cnode_ptr;
+    user_cnode_t *exist_cnode_ptr;
+
+    hyrbtree_compact_init( &ctree );
+
+    printf("\n\ncompact add node:");
+    for( i=0;i<add_array_size && i<USER_POOL_SIZE;i++ ){
+        cnode_pool[i].addr = i;
+        cnode_pool[i].elem = add_array[i];
+        ret = hyrbtree_compact_add_node( &ctree,&cnode_pool[i],(void **)&exist_cnode_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d",add_array[i]);
+        }
+        else if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+            printf(" %d:exist! addr=%d",add_array[i],exist_cnode_ptr->addr);
+        }
+    }
+
+    printf("\ncompact forward:");
+    for( cnode_ptr=hyrbtree_compact_first(&ctree,&cursor);cnode_ptr!=NULL;cnode_ptr=hyrbtree_compact_next(&cursor) ){
+        printf(" %d",cnode_ptr->elem);
+    }
+    printf("\ncompact backward:");
+    for( cnode_ptr=hyrbtree_compact_last(&ctree,&cursor);cnode_ptr!=NULL;cnode_ptr=hyrbtree_compact_prev(&cursor) ){
+        printf(" %d",cnode_ptr->elem);
+    }
+    printf("\ncompact seek %d:",seek_elem);
+    for( cnode_ptr=hyrbtree_compact_seek(&ctree,&cursor,&seek_elem);cnode_ptr!=NULL;cnode_ptr=hyrbtree_compact_next(&cursor) ){
+        printf(" %d",cnode_ptr->elem);
+    }
+
+    printf("\ncompact del node:");
+    for( i=0;i<add_array_size && i<USER_POOL_SIZE;i+=2 ){
+        if( hyrbtree_compact_del_node( &ctree,&cnode_pool[i] )==HYRBTREE_RET_OK ){
+            printf(" %d",cnode_pool[i].elem);
+        }
+    }
+    printf("\ncompact remain:");
+    for( cnode_ptr=hyrbtree_compact_first(&ctree,&cursor);cnode_ptr!=NULL;cnode_ptr=hyrbtree_compact_next(&cursor) ){
+        printf(" %d:addr=%d",cnode_ptr->elem,cnode_ptr->addr);
+    }
+    printf("\ncompact node size=%u count=%u",(uint32_t)sizeof(hyrbcnode_t),ctree.node_count);
+}
+
+/**
+ * @brief Index tree test sequence
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates insert/delete/iteration by array index, then moves the array
+ * and walks the copy to show the links are position-independent.
+ */
+void hyrbtree_idx_test( int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hy_u32_t idx;
+    hy_u32_t exist_idx;
+    user_inode_t inode_pool[USER_POOL_SIZE];
+    user_inode_t inode_copy[USER_POOL_SIZE];
+    hyrbtree_idx_t itree = {
+        HYRBTREE_IDX_INIT(user_inode_t,inode_pool,USER_POOL_SIZE,inode,elem,user_node_cmp_elem),
+    };
+
+    hyrbtree_idx_init( &itree );
+
+    printf("\n\nidx add node:");
+    for( i=0;i<add_array_size && i<USER_POOL_SIZE;i++ ){
+        inode_pool[i].addr = i;
+        inode_pool[i].elem = add_array[i];
+        ret = hyrbtree_idx_add_node( &itree,i,&exist_idx );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d",add_array[i]);
+        }
+        else if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+            printf(" %d:exist! idx=%u",add_array[i],exist_idx);
+        }
+    }
+
+    printf("\nidx del node:");
+    for( i=1;i<add_array_size && i<USER_POOL_SIZE;i+=3 ){
+        if( hyrbtree_idx_del_node( &itree,i )==HYRBTREE_RET_OK ){
+            printf(" %d",inode_pool[i].elem);
+        }
+    }
+
+    printf("\nidx forward:");
+    for( idx=hyrbtree_idx_first(&itree);idx!=HYRBTREE_IDX_NIL;idx=hyrbtree_idx_next(&itree,idx) ){
+        printf(" %d:idx=%u",inode_pool[idx].elem,idx);
+    }
+
+    /* Relocate the array: only node_base changes */
+    memcpy( inode_copy,inode_pool,sizeof(inode_pool) );
+    itree.node_base = inode_copy;
+    printf("\nidx relocated backward:");
+    for( idx=hyrbtree_idx_last(&itree);idx!=HYRBTREE_IDX_NIL;idx=hyrbtree_idx_prev(&itree,idx) ){
+        printf(" %d",inode_copy[idx].elem);
+    }
+    printf("\nidx node size=%u count=%u",(uint32_t)sizeof(hyrbinode_t),itree.node_count);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief Tree file test sequence
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates that a tree written to a mapped file is found again after
+ * closing and reopening it, without rebuilding.
+ */
+void hyrbtree_file_test( int32_t *add_array,uint32_t add_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hy_u32_t idx;
+    user_record_t *record_ptr;
+    user_record_t *exist_record_ptr;
+    hyrbtree_file_t tree_file = {
+        .tree = {
+            .node_stride = sizeof(user_record_t),
+            .rbnode_offset = offsetof(user_record_t,inode),
+            .elem_offset = offsetof(user_record_t,elem),
+            .cmp_elem = user_node_cmp_elem,
+        },
+    };
+    const char *file_path = "hyrbtree_test.hyrb";
+
+    remove( file_path );
+    ret = hyrbtree_file_open( &tree_file,file_path,USER_POOL_SIZE );
+    printf("\n\nfile create: ret=%d",ret);
+    if( ret!=HYRBTREE_RET_OK ){
+        return;
+    }
+
+    printf("\nfile add node:");
+    for( i=0;i<add_array_size;i++ ){
+        if( hyrbtree_file_new_record( &tree_file,(void **)&record_ptr )!=HYRBTREE_RET_OK ){
+            printf(" full!");
+            break;
+        }
+        record_ptr->addr = i;
+        record_ptr->elem = add_array[i];
+        ret = hyrbtree_file_add_node( &tree_file,record_ptr,(void **)&exist_record_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d",add_array[i]);
+        }
+        else{
+            if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                printf(" %d:exist! addr=%d",add_array[i],exist_record_ptr->addr);
+            }
+            hyrbtree_file_free_record( &tree_file,record_ptr );
+        }
+    }
+    if( hyrbtree_file_get_node( &tree_file,&add_array[0],(void **)&record_ptr )==HYRBTREE_RET_OK ){
+        hyrbtree_file_del_node( &tree_file,record_ptr );
+        printf("\nfile del node: %d",add_array[0]);
+    }
+    printf("\nfile close: ret=%d",hyrbtree_file_close( &tree_file ));
+
+    ret = hyrbtree_file_open( &tree_file,file_path,0 );
+    printf("\nfile reopen: ret=%d count=%u",ret,tree_file.tree.node_count);
+    if( ret!=HYRBTREE_RET_OK ){
+        return;
+    }
+    printf("\nfile get node:");
+    for( i=0;i<add_array_size;i++ ){
+        if( hyrbtree_file_get_node( &tree_file,&add_array[i],(void **)&record_ptr )==HYRBTREE_RET_OK ){
+            printf(" %d:addr=%d",record_ptr->elem,record_ptr->addr);
+        }
+        else{
+            printf(" %d:not find!",add_array[i]);
+        }
+    }
+    printf("\nfile forward:");
+    for( idx=hyrbtree_idx_first(&tree_file.tree);idx!=HYRBTREE_IDX_NIL;idx=hyrbtree_idx_next(&tree_file.tree,idx) ){
+        record_ptr = HYRBTREE_IDX_TO_USER( &tree_file.tree,idx );
+        printf(" %d",record_ptr->elem);
+    }
+    hyrbtree_file_close( &tree_file );
+    remove( file_path );
+}
+#endif
+
+/**
+ * @brief Append checkpoint bytes to the buffer
+ * @param arg user_stream_buf_t
+ * @param data Bytes to write
+ * @param len Byte count
+ * @return 1 on success, 0 when the buffer is full
+ */
+hy_u8_t user_stream_write( void *arg,const void *data,hy_u32_t len ){
+    user_stream_buf_t *buf;
+
+    buf = (user_stream_buf_t *)arg;
+    if( len>sizeof(buf->data)-buf->len ){
+        return 0;
+    }
+    memcpy( buf->data+buf->len,data,len );
+    buf->len += len;
+    return 1;
+}
+
+/**
+ * @brief Consume checkpoint bytes from the buffer
+ * @param arg user_stream_buf_t
+ * @param data [out] Buffer to fill
+ * @param len Byte count
+ * @return 1 on success, 0 past the end of the data
+ */
+hy_u8_t user_stream_read( void *arg,void *data,hy_u32_t len ){
+    user_stream_buf_t *buf;
+
+    buf = (user_stream_buf_t *)arg;
+    if( len>buf->len-buf->pos ){
+        return 0;
+    }
+    memcpy( data,buf->data+buf->pos,len );
+    buf->pos += len;
+    return 1;
+}
+
+/**
+ * @brief Encode a node as a record (elem then addr)
+ * @param user_node user_node_t to dump
+ * @param record [out] Record bytes
+ * @param arg user_stream_buf_t (unused)
+ */
+void user_stream_encode( void *user_node,void *record,void *arg ){
+    user_node_t *node;
+
+    (void)arg;
+    node = (user_node_t *)user_node;
+    memcpy( record,&node->elem,sizeof(node->elem) );
+    memcpy( (uint8_t *)record+sizeof(node->elem),&node->addr,sizeof(node->addr) );
+}
+
+/**
+ * @brief Allocate a pool node from a record
+ * @param record Record bytes
+ * @param arg user_stream_buf_t
+ * @return Unlinked node, NULL when the pool is full
+ */
+void *user_stream_decode( void *record,void *arg ){
+    user_stream_buf_t *buf;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+
+    buf = (user_stream_buf_t *)arg;
+    memcpy( &new_node.elem,record,sizeof(new_node.elem) );
+    memcpy( &new_node.addr,(uint8_t *)record+sizeof(new_node.elem),sizeof(new_node.addr) );
+    if( user_pool_new_node( buf->pool,&new_node,&new_node_ptr )!=RET_OK ){
+        return NULL;
+    }
+    return new_node_ptr;
+}
+
+/**
+ * @brief Streaming checkpoint test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Dumps a tree into a compressed in-memory checkpoint, reloads it into an
+ * empty tree, then checks that a damaged header and a truncated stream
+ * are refused with the tree left empty.
+ */
+void hyrbtree_stream_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+    hyrbtree_ret_t ret;
+    user_node_t *cur_node_ptr;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+    };
+    static user_stream_buf_t stream_buf;
+    static hyrbtree_stream_t stream = {
+        .write = user_stream_write,
+        .read = user_stream_read,
+        .encode_node = user_stream_encode,
+        .decode_node = user_stream_decode,
+        .arg = &stream_buf,
+        .record_size = sizeof(int32_t)+sizeof(uint32_t),
+        .compress = 1,
+    };
+
+    hyrbtree_init( &rbtree );
+    user_tree_fill( user_pool,&rbtree,add_array,add_array_size );
+    stream_buf.len = 0;
+    stream_buf.pool = user_pool;
+    ret = hyrbtree_stream_dump( &rbtree,&stream );
+    printf("\n\nstream dump: ret=%d count=%u bytes=%u",ret,hyrbtree_count(&rbtree),stream_buf.len);
+    user_tree_clear( user_pool,&rbtree );
+
+    stream_buf.pos = 0;
+    ret = hyrbtree_stream_load( &rbtree,&stream );
+    printf("\nstream load: ret=%d count=%u",ret,hyrbtree_count(&rbtree));
+    printf("\nstream forward:");
+    for( cur_node_ptr=hyrbtree_first(&rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+        printf(" %d:addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+    }
+    rbtree_preorder( &rbtree,rbtree.root_node,0 );
+    user_tree_clear( user_pool,&rbtree );
+
+    stream_buf.data[0] ^= 0xFF;
+    stream_buf.pos = 0;
+    ret = hyrbtree_stream_load( &rbtree,&stream );
+    printf("\nstream load bad header: ret=%d count=%u",ret,hyrbtree_count(&rbtree));
+    stream_buf.data[0] ^= 0xFF;
+
+    stream_buf.len -= 4;
+    stream_buf.pos = 0;
+    ret = hyrbtree_stream_load( &rbtree,&stream );
+    printf("\nstream load truncated: ret=%d count=%u",ret,hyrbtree_count(&rbtree));
+}
+
+/**
+ * @brief Multimap test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert, with repeats
+ * @param add_array_size Insertion count
+ * @param range_elem Key whose duplicates are listed and thinned
+ * 
+ * Validates that equal keys are all linked in insertion order, that
+ * hyrbtree_get_node returns the first of them and that a duplicate in the
+ * middle of the run is deleted directly.
+ */
+void hyrbtree_multi_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size,int32_t range_elem ){
+    user_node_t *cur_node_ptr;
+    user_node_t *first_node_ptr;
+    user_node_t *last_node_ptr;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+        .multi_elem = 1,
+    };
+
+    hyrbtree_init( &rbtree );
+    user_tree_fill( user_pool,&rbtree,add_array,add_array_size );
+    printf("\n\nmulti forward: count=%u",hyrbtree_count(&rbtree));
+    for( cur_node_ptr=hyrbtree_first(&rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+        printf(" %d:addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+    }
+    if( hyrbtree_get_node( &rbtree,&range_elem,(void **)&cur_node_ptr )==HYRBTREE_RET_OK ){
+        printf("\nmulti get elem=%d addr=%d",range_elem,cur_node_ptr->addr);
+    }
+
+    if( hyrbtree_equal_range( &rbtree,&range_elem,(void **)&first_node_ptr,(void **)&last_node_ptr )==HYRBTREE_RET_OK ){
+        printf("\nmulti equal range %d:",range_elem);
+        for( cur_node_ptr=first_node_ptr;;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+            printf(" addr=%d",cur_node_ptr->addr);
+            if( cur_node_ptr==last_node_ptr ){
+                break;
+            }
+        }
+        cur_node_ptr = hyrbtree_next( &rbtree,first_node_ptr );
+        if( cur_node_ptr!=last_node_ptr ){
+            printf("\nmulti del elem=%d addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+            hyrbtree_del_node( &rbtree,cur_node_ptr );
+            user_pool_del_node( user_pool,cur_node_ptr );
+        }
+    }
+    printf("\nmulti forward: count=%u",hyrbtree_count(&rbtree));
+    for( cur_node_ptr=hyrbtree_first(&rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+        printf(" %d:addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+    }
+    user_tree_clear( user_pool,&rbtree );
+}
+
+/**
+ * @brief Multimap bulk build test sequence
+ * @param user_pool Memory manager
+ * @param sorted_array Elements in non-decreasing order, with repeats
+ * @param sorted_array_size Element count
+ * @param range_elem Key whose duplicates are listed
+ * 
+ * Validates that hyrbtree_build_sorted accepts duplicate keys in multimap
+ * mode, that equal_range and get_node see the whole run in input order,
+ * and that a later insert of the same key lands after the run.
+ */
+void hyrbtree_multi_build_test( user_pool_t *user_pool,int32_t *sorted_array,uint32_t sorted_array_size,
+    int32_t range_elem ){
+
+    uint8_t i;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *cur_node_ptr;
+    user_node_t *first_node_ptr;
+    user_node_t *last_node_ptr;
+    void *build_nodes[USER_POOL_SIZE];
+    uint32_t build_num;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+        .multi_elem = 1,
+    };
+
+    hyrbtree_init( &rbtree );
+    build_num = 0;
+    for( i=0;i<sorted_array_size;i++ ){
+        new_node.elem = sorted_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            build_nodes[ build_num++ ] = new_node_ptr;
+        }
+    }
+    printf("\n\nmulti build sorted: ret=%d",hyrbtree_build_sorted( &rbtree,build_nodes,build_num ));
+
+    new_node.elem = range_elem;
+    new_node.addr = sorted_array_size;
+    if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+        printf("\nmulti build add elem=%d: ret=%d",range_elem,
+            hyrbtree_add_node( &rbtree,new_node_ptr,(void **)&cur_node_ptr ));
+    }
+    if( hyrbtree_get_node( &rbtree,&range_elem,(void **)&cur_node_ptr )==HYRBTREE_RET_OK ){
+        printf("\nmulti build get elem=%d addr=%d",range_elem,cur_node_ptr->addr);
+    }
+    if( hyrbtree_equal_range( &rbtree,&range_elem,(void **)&first_node_ptr,(void **)&last_node_ptr )==HYRBTREE_RET_OK ){
+        printf("\nmulti build equal range %d:",range_elem);
+        for( cur_node_ptr=first_node_ptr;;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+            printf(" addr=%d",cur_node_ptr->addr);
+            if( cur_node_ptr==last_node_ptr ){
+                break;
+            }
+        }
+    }
+    printf("\nmulti build forward: count=%u",hyrbtree_count(&rbtree));
+    for( cur_node_ptr=hyrbtree_first(&rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+        printf(" %d:addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+    }
+    user_tree_clear( user_pool,&rbtree );
+}
+
+/**
+ * @brief Single-descent upsert and delete-by-key test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to upsert, with repeats
+ * @param add_array_size Upsert count
+ * @param del_array Keys to delete
+ * @param del_array_size Delete count
+ * 
+ * Validates that hyrbtree_find_or_add reports existing keys without
+ * linking the spare node, and that hyrbtree_del_by_elem hands back the
+ * removed node.
+ */
+void hyrbtree_upsert_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size,
+    int32_t *del_array,uint32_t del_array_size ){
+
+    uint8_t i;
+    hy_u8_t inserted;
+    hyrbtree_ret_t ret;
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *ret_node_ptr;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+    };
+
+    hyrbtree_init( &rbtree );
+    printf("\n\nfind or add:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            hyrbtree_find_or_add( &rbtree,new_node_ptr,(void **)&ret_node_ptr,&inserted );
+            if( inserted!=0 ){
+                printf(" %d:add",add_array[i]);
+            }
+            else{
+                printf(" %d:exist addr=%d",add_array[i],ret_node_ptr->addr);
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+
+    printf("\ndel by elem:");
+    for( i=0;i<del_array_size;i++ ){
+        ret = hyrbtree_del_by_elem( &rbtree,&del_array[i],(void **)&ret_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d:del addr=%d",del_array[i],ret_node_ptr->addr);
+            user_pool_del_node( user_pool,ret_node_ptr );
+        }
+        else{
+            printf(" %d:not find!",del_array[i]);
+        }
+    }
+    printf("\nupsert forward: count=%u",hyrbtree_count(&rbtree));
+    for( ret_node_ptr=hyrbtree_first(&rbtree);ret_node_ptr!=NULL;ret_node_ptr=hyrbtree_next(&rbtree,ret_node_ptr) ){
+        printf(" %d:addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+    }
+    user_tree_clear( user_pool,&rbtree );
+}
+
+/**
+ * @brief Priority queue test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param pop_num Number of pops from each end
+ * 
+ * Validates that the cached first/last nodes follow inserts and pops from
+ * both ends until the tree is empty.
+ */
+void hyrbtree_pop_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size,uint32_t pop_num ){
+    uint32_t i;
+    user_node_t *cur_node_ptr;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+    };
+
+    hyrbtree_init( &rbtree );
+    user_tree_fill( user_pool,&rbtree,add_array,add_array_size );
+    printf("\n\npop first:");
+    for( i=0;i<pop_num;i++ ){
+        if( hyrbtree_pop_first( &rbtree,(void **)&cur_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" %d",cur_node_ptr->elem);
+            user_pool_del_node( user_pool,cur_node_ptr );
+        }
+    }
+    printf("\npop last:");
+    for( i=0;i<pop_num;i++ ){
+        if( hyrbtree_pop_last( &rbtree,(void **)&cur_node_ptr )==HYRBTREE_RET_OK ){
+            printf(" %d",cur_node_ptr->elem);
+            user_pool_del_node( user_pool,cur_node_ptr );
+        }
+    }
+    cur_node_ptr = hyrbtree_first( &rbtree );
+    if( cur_node_ptr!=NULL ){
+        printf("\npop remain: count=%u first=%d last=%d",hyrbtree_count(&rbtree),
+            cur_node_ptr->elem,((user_node_t *)hyrbtree_last(&rbtree))->elem);
+    }
+    printf("\npop drain:");
+    while( hyrbtree_pop_first( &rbtree,(void **)&cur_node_ptr )==HYRBTREE_RET_OK ){
+        printf(" %d",cur_node_ptr->elem);
+        user_pool_del_node( user_pool,cur_node_ptr );
+    }
+    printf("\npop empty: ret=%d",hyrbtree_pop_last( &rbtree,(void **)&cur_node_ptr ));
+}
+
+/**
+ * @brief Timer expiry callback
+ * @param timer_node Expired timer
+ * @param arg Owning scheduler (hyrbtree_timer_t *)
+ * 
+ * Prints the timer and re-arms periodic ones one period after the deadline.
+ */
+void user_timer_expire( hyrbtree_timer_node_t *timer_node,void *arg ){
+    user_timer_t *user_timer;
+
+    user_timer = HYRBTREE_CONTAINER_OF(timer_node,user_timer_t,timer);
+    printf(" %d@%llu",user_timer->addr,(unsigned long long)timer_node->expire);
+    if( user_timer->period!=0 ){
+        hyrbtree_timer_arm( (hyrbtree_timer_t *)arg,timer_node,timer_node->expire+user_timer->period );
+    }
+}
+
+/**
+ * @brief Print armed timers in deadline order
+ * @param timer Timer scheduler
+ */
+void user_timer_print( hyrbtree_timer_t *timer ){
+    hyrbtree_timer_node_t *timer_node;
+
+    printf("\ntimer armed:");
+    for( timer_node=hyrbtree_first(&timer->tree);timer_node!=NULL;
+        timer_node=hyrbtree_next(&timer->tree,timer_node) ){
+        printf(" %d@%llu",HYRBTREE_CONTAINER_OF(timer_node,user_timer_t,timer)->addr,
+            (unsigned long long)timer_node->expire);
+    }
+}
+
+/**
+ * @brief Timer scheduler test sequence
+ * @param expire_array Initial deadlines, one timer each (at most 16)
+ * @param expire_array_size Timer count
+ * @param now_array Clock values passed to expire_until
+ * @param now_array_size Expiry rounds
+ * 
+ * Validates FIFO order among equal deadlines, in-place and relocating
+ * re-arms, cancellation, and batch expiry with periodic re-arming from
+ * the callback.
+ */
+void hyrbtree_timer_test( uint64_t *expire_array,uint32_t expire_array_size,
+    uint64_t *now_array,uint32_t now_array_size ){
+
+    uint32_t i;
+    uint32_t expire_num;
+    uint64_t next_expire;
+    hyrbtree_timer_t timer;
+    user_timer_t user_timer[16];
+
+    memset( user_timer,0,sizeof(user_timer) );
+    hyrbtree_timer_init( &timer );
+    for( i=0;i<expire_array_size;i++ ){
+        user_timer[i].addr = (int32_t)i;
+        user_timer[i].period = (i%3==0) ? 25 : 0;
+        hyrbtree_timer_arm( &timer,&user_timer[i].timer,expire_array[i] );
+    }
+    user_timer_print( &timer );
+    printf("\ntimer arm again: ret=%d",hyrbtree_timer_arm( &timer,&user_timer[0].timer,1 ));
+
+    /* Between its neighbors: rewritten in place; past them: relocated */
+    hyrbtree_timer_rearm( &timer,&user_timer[3].timer,user_timer[3].timer.expire+5 );
+    hyrbtree_timer_rearm( &timer,&user_timer[2].timer,1 );
+    hyrbtree_timer_cancel( &timer,&user_timer[1].timer );
+    printf("\ntimer cancel again: ret=%d armed=%u",
+        hyrbtree_timer_cancel( &timer,&user_timer[1].timer ),hyrbtree_timer_armed( &user_timer[1].timer ));
+    user_timer_print( &timer );
+
+    for( i=0;i<now_array_size;i++ ){
+        printf("\ntimer expire until %llu:",(unsigned long long)now_array[i]);
+        expire_num = hyrbtree_timer_expire_until( &timer,now_array[i],user_timer_expire,&timer );
+        printf(" (%u)",expire_num);
+        if( hyrbtree_timer_next_expire( &timer,&next_expire )==HYRBTREE_RET_OK ){
+            printf(" next=%llu count=%u",(unsigned long long)next_expire,hyrbtree_count( &timer.tree ));
+        }
+    }
+    user_timer_print( &timer );
+}
+
+/**
+ * @brief Rekey callback: store a new int32_t key
+ * @param user_node Node being rekeyed (user_node_t *)
+ * @param elem New key (int32_t *)
+ */
+void user_node_set_elem( void *user_node,void *elem ){
+    ((user_node_t *)user_node)->elem = *(int32_t *)elem;
+}
+
+/**
+ * @brief In-place rekey test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * @param from_array Keys to change
+ * @param to_array New key for each entry of from_array
+ * @param rekey_array_size Rekey count
+ * 
+ * Validates that a key still between its neighbors keeps the node in
+ * place, that other keys are relocated, and that a collision leaves the
+ * node linked under its old key.
+ */
+void hyrbtree_rekey_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size,
+    int32_t *from_array,int32_t *to_array,uint32_t rekey_array_size ){
+
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    user_node_t *cur_node_ptr;
+    user_node_t *prev_node_ptr;
+    user_node_t *next_node_ptr;
+    user_node_t *exist_node_ptr;
+    hyrbtree_t rbtree = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+    };
+
+    hyrbtree_init( &rbtree );
+    user_tree_fill( user_pool,&rbtree,add_array,add_array_size );
+    printf("\n\nrekey:");
+    for( i=0;i<rekey_array_size;i++ ){
+        if( hyrbtree_get_node( &rbtree,&from_array[i],(void **)&cur_node_ptr )!=HYRBTREE_RET_OK ){
+            printf(" %d:not find!",from_array[i]);
+            continue;
+        }
+        prev_node_ptr = hyrbtree_prev( &rbtree,cur_node_ptr );
+        next_node_ptr = hyrbtree_next( &rbtree,cur_node_ptr );
+        ret = hyrbtree_rekey_node( &rbtree,cur_node_ptr,&to_array[i],user_node_set_elem,(void **)&exist_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf(" %d->%d:%s",from_array[i],to_array[i],
+                (hyrbtree_prev( &rbtree,cur_node_ptr )==prev_node_ptr &&
+                hyrbtree_next( &rbtree,cur_node_ptr )==next_node_ptr) ? "stay" : "move");
+        }
+        else{
+            printf(" %d->%d:exist addr=%d",from_array[i],to_array[i],exist_node_ptr->addr);
+        }
+    }
+    printf("\nrekey forward: count=%u",hyrbtree_count(&rbtree));
+    for( cur_node_ptr=hyrbtree_first(&rbtree);cur_node_ptr!=NULL;cur_node_ptr=hyrbtree_next(&rbtree,cur_node_ptr) ){
+        printf(" %d:addr=%d",cur_node_ptr->elem,cur_node_ptr->addr);
+    }
+    user_tree_clear( user_pool,&rbtree );
+}
+
+/* Specialized tree over user_node_t with inlined int32_t key comparison */
+HYRBTREE_SPEC_DEFINE(user_spec,user_node_t,rbnode,elem,int32_t,HYRBTREE_SPEC_CMP_SCALAR)
+
+/**
+ * @brief Specialized tree test sequence
+ * @param user_pool Memory manager
+ * @param add_array Elements to insert
+ * @param add_array_size Insertion count
+ * 
+ * Validates that nodes added through the generated functions are found by
+ * both the generated lookup and the callback API, then removes them.
+ */
+void hyrbtree_spec_test( user_pool_t *user_pool,int32_t *add_array,uint32_t add_array_size ){
+    uint8_t i;
+    hyrbtree_ret_t ret;
+    hyrbtree_t rbtree = {
+        .root_node = NULL,
+    };
+    user_node_t new_node = {
+        .rbnode = {
+            .user_node = NULL,
+        },
+        .next_node = NULL,
+    };
+    user_node_t *new_node_ptr;
+    user_node_t *exist_node_ptr;
+    user_node_t *ret_node_ptr;
+
+    user_spec_init( &rbtree );
+
+    printf("\n\nspec add node:");
+    for( i=0;i<add_array_size;i++ ){
+        new_node.elem = add_array[i];
+        new_node.addr = i;
+
+        if( user_pool_new_node( user_pool,&new_node,&new_node_ptr )==RET_OK ){
+            ret = user_spec_add_node( &rbtree,new_node_ptr,&exist_node_ptr );
+            printf("\nAdd node elem=%d",new_node.elem);
+            if( ret==HYRBTREE_RET_OK ){
+                printf(" success!");
+            }
+            else if( ret==HYRBTREE_RET_ADD_NODE_ELEM_EXIST ){
+                printf(" exist! addr=%d",exist_node_ptr->addr);
+                user_pool_del_node( user_pool,new_node_ptr );
+            }
+        }
+    }
+    printf("\n\nrbtree_preorder:");
+    rbtree_preorder( &rbtree,rbtree.root_node,0 );
+
+    printf("\n\nspec get/del node:");
+    for( i=0;i<add_array_size;i++ ){
+        ret = user_spec_get_node( &rbtree,add_array[i],&ret_node_ptr );
+        if( ret==HYRBTREE_RET_OK ){
+            printf("\nget elem=%d addr=%d",ret_node_ptr->elem,ret_node_ptr->addr);
+            if( hyrbtree_get_node( &rbtree,&add_array[i],(void **)&exist_node_ptr )==HYRBTREE_RET_OK &&
+                exist_node_ptr==ret_node_ptr ){
+                printf(" match!");
+            }
+            if( user_spec_del_node( &rbtree,ret_node_ptr )==HYRBTREE_RET_OK ){
+                user_pool_del_node( user_pool,ret_node_ptr );
+                printf(" del!");
+            }
+        }
+        else{
+            printf("\nget elem=%d not find!",add_array[i]);
+        }
+    }
+}
+
+#if HYRBTREE_CFG_KEY_CACHE
+/**
+ * @brief Callback: Project key onto the node key cache
+ * @param elem Key element
+ * @return Order-preserving 64-bit prefix
+ */
+hy_u64_t user_node_elem_cache( void *elem ){
+    return HYRBTREE_ELEM_CACHE_INT(*(int32_t *)elem);
+}
+#endif
+
 /**
  * @brief Main test entry point
  * 
  * Executes test sequences:
  * 1. Balanced insertion/deletion
  * 2. Collision-heavy scenario
+ * 3. Collision-heavy scenario (offset registration mode)
+ * 4. In-order iteration
+ * 5. Ordered search and range scan
+ * 6. Bulk build from sorted input
+ * 7. Sorted batch insert
+ * 8. Hinted insert and lookup
+ * 9. Order statistics (count, select, rank)
+ * 10. Augmented tree with range sums
+ * 11. Interval tree overlap and stabbing queries
+ * 12. Concurrent tree writer/reader protocol
+ * 13. Sharded container with range split
+ * 14. Flat-combining writer path
+ * 15. Persistent tree snapshots
+ * 16. Parent-free compact tree with cursors
+ * 17. Index-addressed tree over a node array
+ * 18. Memory-mapped tree file reopen
+ * 19. Streaming checkpoint and reload
+ * 20. Multimap with duplicate keys
+ * 21. Multimap bulk build with duplicate keys
+ * 22. Single-descent upsert and delete by key
+ * 23. Priority queue pops from both ends
+ * 24. Deadline timer scheduler
+ * 25. In-place rekey
+ * 26. Compile-time specialized tree
  * 
  * Each test validates:
  * - Tree structural integrity
@@ -325,9 +2059,131 @@ void hyrbtree_test(void){
         temp_add_array,sizeof(temp_add_array)/sizeof(int32_t),
         temp_del_array,sizeof(temp_del_array)/sizeof(int32_t) );
 
+    hyrbtree_t rbtree_offset = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+#if HYRBTREE_CFG_KEY_CACHE
+        .get_elem_cache = user_node_elem_cache,
+#endif
+    };
+    hyrbtree_init( &rbtree_offset );
+
     int32_t temp_add_array2[] = {10, 5, 15, 16, 3, 7, 12, 20, 16, 7, 4, 6, 16, 9, 11};
     int32_t temp_del_array2[] = {99, 7, 11, 5, 9, 12, 16, 20, 10, 15, 3, 16, 4, 6, 7, 16};
     hyrbtree_add_del_test( &user_pool,&rbtree,
         temp_add_array2,sizeof(temp_add_array2)/sizeof(int32_t),
         temp_del_array2,sizeof(temp_del_array2)/sizeof(int32_t) );
+    hyrbtree_add_del_test( &user_pool,&rbtree_offset,
+        temp_add_array2,sizeof(temp_add_array2)/sizeof(int32_t),
+        temp_del_array2,sizeof(temp_del_array2)/sizeof(int32_t) );
+
+    int32_t temp_iter_array[] = {50, 20, 80, 10, 30, 70, 90, 25, 35, 75, 5, 95};
+    hyrbtree_iter_test( &user_pool,&rbtree_offset,
+        temp_iter_array,sizeof(temp_iter_array)/sizeof(int32_t) );
+
+    int32_t temp_bound_add_array[] = {10, 20, 30, 40, 50};
+    int32_t temp_bound_query_array[] = {5, 10, 25, 40, 55};
+    hyrbtree_bound_test( &user_pool,&rbtree_offset,
+        temp_bound_add_array,sizeof(temp_bound_add_array)/sizeof(int32_t),
+        temp_bound_query_array,sizeof(temp_bound_query_array)/sizeof(int32_t) );
+
+    int32_t temp_build_array[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    hyrbtree_build_test( &user_pool,&rbtree_offset,
+        temp_build_array,sizeof(temp_build_array)/sizeof(int32_t) );
+
+    int32_t temp_batch_array[] = {42, 17, 8, 23, 17, 4, 15, 16, 42, 99};
+    hyrbtree_batch_test( &user_pool,&rbtree_offset,
+        temp_batch_array,sizeof(temp_batch_array)/sizeof(int32_t) );
+
+    int32_t temp_hint_array[] = {100, 110, 120, 130, 125, 140, 150, 150, 160, 105};
+    hyrbtree_hint_test( &user_pool,&rbtree_offset,
+        temp_hint_array,sizeof(temp_hint_array)/sizeof(int32_t) );
+
+    int32_t temp_order_add_array[] = {60, 20, 40, 10, 50, 30, 40};
+    int32_t temp_order_query_array[] = {5, 10, 35, 60, 70};
+    hyrbtree_order_test( &user_pool,&rbtree_offset,
+        temp_order_add_array,sizeof(temp_order_add_array)/sizeof(int32_t),
+        temp_order_query_array,sizeof(temp_order_query_array)/sizeof(int32_t) );
+
+    hyrbtree_t rbtree_augment = {
+        HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem),
+        .augment_node = user_node_augment,
+    };
+    hyrbtree_init( &rbtree_augment );
+
+    int32_t temp_augment_add_array[] = {5, 1, 9, 3, 7, 2, 8, 4, 6, 10};
+    int32_t temp_augment_range_array[] = {1, 10, 3, 7, 0, 4, 8, 20, 11, 12};
+    hyrbtree_augment_test( &user_pool,&rbtree_augment,
+        temp_augment_add_array,sizeof(temp_augment_add_array)/sizeof(int32_t),
+        temp_augment_range_array,sizeof(temp_augment_range_array)/sizeof(int32_t) );
+
+    uint64_t temp_interval_range_array[] = {10, 20, 15, 25, 30, 40, 5, 8, 15, 16, 50, 45, 22, 35};
+    uint64_t temp_interval_query_array[] = {16, 18, 26, 29, 0, 4, 33, 60};
+    hyrbtree_interval_test( temp_interval_range_array,sizeof(temp_interval_range_array)/sizeof(uint64_t),
+        temp_interval_query_array,sizeof(temp_interval_query_array)/sizeof(uint64_t) );
+
+    int32_t temp_sync_array[] = {300, 100, 200, 400, 100};
+    hyrbtree_sync_test( &user_pool,
+        temp_sync_array,sizeof(temp_sync_array)/sizeof(int32_t) );
+
+    int32_t temp_shard_array[] = {90, 10, 50, 30, 70, 20, 80, 40, 60, 15};
+    hyrbtree_shard_test( &user_pool,
+        temp_shard_array,sizeof(temp_shard_array)/sizeof(int32_t) );
+
+    int32_t temp_fc_array[] = {7, 3, 11, 5, 3, 9, 1};
+    hyrbtree_fc_test( &user_pool,
+        temp_fc_array,sizeof(temp_fc_array)/sizeof(int32_t) );
+
+    int32_t temp_persist_array[] = {10, 4, 16, 2, 8, 12, 20, 8, 6};
+    hyrbtree_persist_test( &user_pool,
+        temp_persist_array,sizeof(temp_persist_array)/sizeof(int32_t) );
+
+    int32_t temp_compact_array[] = {50, 20, 80, 10, 30, 70, 90, 30, 60, 40};
+    hyrbtree_compact_test( temp_compact_array,sizeof(temp_compact_array)/sizeof(int32_t),35 );
+
+    int32_t temp_idx_array[] = {33, 11, 55, 22, 44, 66, 11, 77, 5};
+    hyrbtree_idx_test( temp_idx_array,sizeof(temp_idx_array)/sizeof(int32_t) );
+
+#if defined(__unix__) || defined(__APPLE__)
+    int32_t temp_file_array[] = {400, 100, 700, 300, 100, 600, 200};
+    hyrbtree_file_test( temp_file_array,sizeof(temp_file_array)/sizeof(int32_t) );
+#endif
+
+    int32_t temp_stream_array[] = {25, 5, 45, 15, 35, 5, 55, 65};
+    hyrbtree_stream_test( &user_pool,
+        temp_stream_array,sizeof(temp_stream_array)/sizeof(int32_t) );
+
+    int32_t temp_multi_array[] = {20, 10, 20, 30, 20, 10, 20};
+    hyrbtree_multi_test( &user_pool,
+        temp_multi_array,sizeof(temp_multi_array)/sizeof(int32_t),20 );
+
+    int32_t temp_multi_build_array[] = {10, 20, 20, 20, 20, 20, 30, 30, 40};
+    hyrbtree_multi_build_test( &user_pool,
+        temp_multi_build_array,sizeof(temp_multi_build_array)/sizeof(int32_t),20 );
+
+    int32_t temp_upsert_array[] = {40, 20, 60, 20, 50, 40};
+    int32_t temp_upsert_del_array[] = {20, 30, 60};
+    hyrbtree_upsert_test( &user_pool,
+        temp_upsert_array,sizeof(temp_upsert_array)/sizeof(int32_t),
+        temp_upsert_del_array,sizeof(temp_upsert_del_array)/sizeof(int32_t) );
+
+    int32_t temp_pop_array[] = {45, 15, 75, 5, 35, 95, 25, 65, 85, 55};
+    hyrbtree_pop_test( &user_pool,
+        temp_pop_array,sizeof(temp_pop_array)/sizeof(int32_t),3 );
+
+    uint64_t temp_timer_expire_array[] = {30, 10, 50, 20, 10, 40, 30, 60, 10};
+    uint64_t temp_timer_now_array[] = {10, 35, 100};
+    hyrbtree_timer_test(
+        temp_timer_expire_array,sizeof(temp_timer_expire_array)/sizeof(uint64_t),
+        temp_timer_now_array,sizeof(temp_timer_now_array)/sizeof(uint64_t) );
+
+    int32_t temp_rekey_array[] = {10, 20, 30, 40, 50, 60};
+    int32_t temp_rekey_from_array[] = {20, 30, 60, 10, 40};
+    int32_t temp_rekey_to_array[] = {22, 5, 65, 50, 45};
+    hyrbtree_rekey_test( &user_pool,
+        temp_rekey_array,sizeof(temp_rekey_array)/sizeof(int32_t),
+        temp_rekey_from_array,temp_rekey_to_array,sizeof(temp_rekey_from_array)/sizeof(int32_t) );
+
+    int32_t temp_spec_array[] = {8, 3, 13, 1, 6, 11, 15, 6, 14};
+    hyrbtree_spec_test( &user_pool,
+        temp_spec_array,sizeof(temp_spec_array)/sizeof(int32_t) );
 }
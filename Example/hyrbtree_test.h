@@ -12,7 +12,17 @@
 #define HYRBTREE_TEST_H
 
 #include <stdio.h>
+#include <string.h>
 #include "hyrbtree.h"
+#include "hyrbtree_interval.h"
+#include "hyrbtree_shard.h"
+#include "hyrbtree_fc.h"
+#include "hyrbtree_persist.h"
+#include "hyrbtree_compact.h"
+#include "hyrbtree_idx.h"
+#include "hyrbtree_file.h"
+#include "hyrbtree_stream.h"
+#include "hyrbtree_timer.h"
 
 
 
@@ -32,17 +42,62 @@ enum{
  * Demonstrates multi-index capability by:
  * - Embedding rbnode for tree management
  * - Supporting linked list for hash collisions
+ * - Carrying a subtree aggregate (elem_sum) for augmentation
  */
 typedef struct user_node_t{
     uint32_t idx;
 
     uint32_t addr;
     int32_t elem;
+    int32_t elem_sum;
     hyrbnode_t rbnode;
 
     struct user_node_t *next_node;
 }user_node_t;
 
+/**
+ * @brief Interval test structure
+ * 
+ * Embeds hyrbtree_interval_t; addr identifies the range in output.
+ */
+typedef struct{
+    uint32_t addr;
+    hyrbtree_interval_t interval;
+}user_range_t;
+
+/**
+ * @brief Compact tree test structure
+ * 
+ * Embeds the parent-free hyrbcnode_t instead of hyrbnode_t.
+ */
+typedef struct{
+    uint32_t addr;
+    int32_t elem;
+    hyrbcnode_t cnode;
+}user_cnode_t;
+
+/**
+ * @brief Index tree test structure
+ * 
+ * Array element linked by hyrbinode_t indices.
+ */
+typedef struct{
+    uint32_t addr;
+    int32_t elem;
+    hyrbinode_t inode;
+}user_inode_t;
+
+/**
+ * @brief Tree file record
+ * 
+ * Fixed-size, pointer-free record stored in the mapped file.
+ */
+typedef struct{
+    uint32_t addr;
+    int32_t elem;
+    hyrbinode_t inode;
+}user_record_t;
+
 /**
  * @brief Bounded memory pool manager
  * 
@@ -61,6 +116,41 @@ typedef struct{
     uint32_t write_pos;
 }user_pool_t;
 
+/**
+ * @brief Fixed node pool for the persistent tree
+ * 
+ * Free nodes are chained through left_node; used_num tracks nodes held by
+ * all live versions plus the tree's spares.
+ */
+typedef struct{
+    hyrbtree_pnode_t nodes[64];
+    hyrbtree_pnode_t *free_node;
+    uint32_t used_num;
+}user_pnode_pool_t;
+
+/**
+ * @brief In-memory checkpoint buffer
+ * 
+ * Backs the stream read/write callbacks; decoded nodes come from pool.
+ */
+typedef struct{
+    uint8_t data[512];
+    uint32_t len;
+    uint32_t pos;
+    user_pool_t *pool;
+}user_stream_buf_t;
+
+/**
+ * @brief Timer-driven test object
+ * 
+ * A non-zero period re-arms the timer from its expiry callback.
+ */
+typedef struct{
+    int32_t addr;
+    uint32_t period;
+    hyrbtree_timer_node_t timer;
+}user_timer_t;
+
 
     
 /** Entry point for test suite execution */
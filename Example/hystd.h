@@ -15,6 +15,33 @@
 
 typedef uintptr_t                           hy_uptr_t;
 typedef uint8_t 							hy_u8_t;
+typedef uint16_t							hy_u16_t;
+typedef uint32_t							hy_u32_t;
 typedef int32_t								hy_i32_t;
+typedef uint64_t							hy_u64_t;
+typedef int64_t								hy_i64_t;
+
+/* Non-binding read prefetch hint */
+#if defined(__GNUC__) || defined(__clang__)
+#define HY_PREFETCH(addr)                   __builtin_prefetch(addr)
+#else
+#define HY_PREFETCH(addr)                   ((void)(addr))
+#endif
+
+/* Minimum alignment of a type or object (keeps hot shared fields on separate cache lines) */
+#if defined(__GNUC__) || defined(__clang__)
+#define HY_ALIGNED(n)                       __attribute__((aligned(n)))
+#else
+#define HY_ALIGNED(n)
+#endif
+
+/* Spin-wait hint for busy loops */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HY_CPU_RELAX()                      __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define HY_CPU_RELAX()                      __asm__ __volatile__("yield")
+#else
+#define HY_CPU_RELAX()                      ((void)0)
+#endif
 
 #endif
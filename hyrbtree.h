@@ -16,11 +16,42 @@
 
 
 
+/* Number of lookups advanced in lockstep by hyrbtree_get_nodes */
+#ifndef HYRBTREE_CFG_GET_LANES
+#define HYRBTREE_CFG_GET_LANES          8
+#endif
+
+/* Keep a subtree size in each hyrbnode_t for rank/select */
+#ifndef HYRBTREE_CFG_SUBTREE_SIZE
+#define HYRBTREE_CFG_SUBTREE_SIZE       0
+#endif
+
+/* Store a fixed-width key copy in each hyrbnode_t for cache-friendly descent */
+#ifndef HYRBTREE_CFG_KEY_CACHE
+#define HYRBTREE_CFG_KEY_CACHE          0
+#endif
+
 /* Macro to extract node address from color-encoded pointer */
 #define HYRBTREE_GET_NODE_ADDR(n)       ((void* )((hy_uptr_t)((n)->user_node) & ~(hy_uptr_t)(0x1)))
 
 /* Macro to read node color (0=RED, 1=BLACK) */
 #define HYRBTREE_READ_NODE_COLOR(n)     ((hy_uptr_t)((n)->user_node) & (hy_uptr_t)(0x1))
+
+/* Macro to get container address from an embedded member without loading user_node */
+#define HYRBTREE_CONTAINER_OF(ptr,type,member)  ((type *)((hy_u8_t *)(ptr)-offsetof(type,member)))
+
+/**
+ * Initializer for offset registration mode:
+ * hyrbtree_t rbtree = { HYRBTREE_OFFSET_INIT(user_node_t,rbnode,elem,user_node_cmp_elem) };
+ */
+#define HYRBTREE_OFFSET_INIT(type,rbnode_member,elem_member,cmp)                        \
+    .rbnode_offset = offsetof(type,rbnode_member),                                      \
+    .elem_offset = offsetof(type,elem_member),                                          \
+    .cmp_elem = (cmp)
+
+/* Order-preserving key cache projections for signed and unsigned integer keys */
+#define HYRBTREE_ELEM_CACHE_INT(v)      ((hy_u64_t)(hy_i64_t)(v) ^ ((hy_u64_t)1<<63))
+#define HYRBTREE_ELEM_CACHE_UINT(v)     ((hy_u64_t)(v))
 enum{
     HYRBTREE_NODE_RED,
     HYRBTREE_NODE_BLACK,
@@ -40,6 +71,17 @@ typedef enum{
     HYRBTREE_RET_GET_NODE_TREE_NULL,
     HYRBTREE_RET_REPLACE_CMP_ERROR,
     HYRBTREE_RET_REPLACE_INIT_ERROR,
+    HYRBTREE_RET_BUILD_TREE_NOT_EMPTY,
+    HYRBTREE_RET_BUILD_NODE_UNINITIALIZED,
+    HYRBTREE_RET_INTERVAL_RANGE_ERROR,
+    HYRBTREE_RET_SHARD_SPLIT_ERROR,
+    HYRBTREE_RET_PERSIST_ALLOC_ERROR,
+    HYRBTREE_RET_FILE_IO_ERROR,
+    HYRBTREE_RET_FILE_FORMAT_ERROR,
+    HYRBTREE_RET_FILE_FULL,
+    HYRBTREE_RET_BUILD_SOURCE_ERROR,
+    HYRBTREE_RET_STREAM_IO_ERROR,
+    HYRBTREE_RET_STREAM_FORMAT_ERROR,
 }hyrbtree_ret_t;
 
 
@@ -49,6 +91,12 @@ typedef struct hyrbnode_t{
     struct hyrbnode_t *parent_node;
     struct hyrbnode_t *left_node;
     struct hyrbnode_t *right_node;
+#if HYRBTREE_CFG_KEY_CACHE
+    hy_u64_t elem_cache;    ///< Order-preserving key prefix (see get_elem_cache)
+#endif
+#if HYRBTREE_CFG_SUBTREE_SIZE
+    hy_u32_t subtree_size;  ///< Number of nodes in the subtree rooted here (0 for nil_node)
+#endif
 }hyrbnode_t;
 
 typedef struct{
@@ -56,6 +104,8 @@ typedef struct{
      * @brief Callback to locate embedded node
      * @param user_node Container structure
      * @return Pointer to embedded hyrbnode_t
+     * 
+     * Leave HY_NULL to locate the node by rbnode_offset instead.
      */
     hyrbnode_t* (*get_rbnode)(void *user_node);
     
@@ -63,6 +113,8 @@ typedef struct{
      * @brief Callback to extract key element
      * @param user_node Container structure
      * @return Pointer to comparable key
+     * 
+     * Leave HY_NULL to locate the key by elem_offset instead.
      */
     void* (*get_elem)(void *user_node);
     
@@ -74,17 +126,232 @@ typedef struct{
      */
     hy_i32_t (*cmp_elem)(void *elem1, void *elem2);
     
+#if HYRBTREE_CFG_KEY_CACHE
+    /**
+     * @brief Callback to project a key onto the node key cache
+     * @param elem Key element
+     * @return 64-bit prefix, cmp_elem(a,b)<0 must imply cache(a)<=cache(b)
+     * 
+     * Leave HY_NULL to disable the cache. Descents decide direction from
+     * the cached prefix and call cmp_elem only when prefixes are equal.
+     */
+    hy_u64_t (*get_elem_cache)(void *elem);
+#endif
+
+    /**
+     * @brief Callback to recompute a node's subtree aggregate
+     * @param user_node Container whose aggregate is refreshed
+     * @param left_node Left child container, HY_NULL if none
+     * @param right_node Right child container, HY_NULL if none
+     * @return 0 if the aggregate is unchanged, non-zero otherwise
+     *
+     * Leave HY_NULL when no aggregate is kept. Called bottom-up wherever the
+     * shape of the tree changes; the return value lets insert paths stop
+     * early, so returning 1 unconditionally is always safe.
+     */
+    hy_u8_t (*augment_node)(void *user_node,void *left_node,void *right_node);
+
+    hy_uptr_t rbnode_offset;    ///< offsetof embedded hyrbnode_t (used when get_rbnode is HY_NULL)
+    hy_uptr_t elem_offset;      ///< offsetof key element (used when get_elem is HY_NULL)
+    hy_u8_t multi_elem;         ///< Non-zero for multimap mode: equal keys are kept in insertion order
+
+    hy_u32_t node_count;    ///< Number of linked nodes
     hyrbnode_t *root_node;  ///< Root of tree (points to nil_node when empty)
+    hyrbnode_t *first_node; ///< Leftmost node (nil_node when empty)
+    hyrbnode_t *last_node;  ///< Rightmost node (nil_node when empty)
     hyrbnode_t nil_node;    ///< Sentinel node (always black)
 } hyrbtree_t;
 
 
 
+/**
+ * @brief Callback for scans
+ * @param user_node Visited container structure
+ * @param arg User argument
+ * @return 0 to continue, non-zero to stop
+ */
+typedef hy_u8_t (*hyrbtree_visit_t)( void *user_node,void *arg );
+
+/**
+ * @brief Callback for range aggregates
+ * @param user_node Contributing container structure
+ * @param whole_subtree Non-zero to take the node's subtree aggregate, 0 for the node alone
+ * @param arg User argument
+ */
+typedef void (*hyrbtree_collect_t)( void *user_node,hy_u8_t whole_subtree,void *arg );
+
+/**
+ * @brief Callback for rekeying
+ * @param user_node Container whose key is rewritten in place
+ * @param elem New key to store
+ */
+typedef void (*hyrbtree_update_t)( void *user_node,void *elem );
+
+
+
 /* Core API Functions */
 void hyrbtree_init( hyrbtree_t *tree );
 hyrbtree_ret_t hyrbtree_add_node( hyrbtree_t *tree,void *user_node,void **exist_node );
 hyrbtree_ret_t hyrbtree_del_node( hyrbtree_t *tree,void *user_node );
 hyrbtree_ret_t hyrbtree_get_node( hyrbtree_t *tree,void *elem,void **get_node );
 hyrbtree_ret_t hyrbtree_replace_node( hyrbtree_t *tree,void *old_node,void *new_node );
+hyrbtree_ret_t hyrbtree_get_nodes( hyrbtree_t *tree,void **elems,hy_u32_t elem_num,void **get_nodes );
+hyrbtree_ret_t hyrbtree_add_node_hint( hyrbtree_t *tree,void *hint_node,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_get_node_hint( hyrbtree_t *tree,void *hint_node,void *get_node_elem,void **get_node );
+hyrbtree_ret_t hyrbtree_find_or_add( hyrbtree_t *tree,void *user_node,void **get_node,hy_u8_t *inserted );
+hyrbtree_ret_t hyrbtree_del_by_elem( hyrbtree_t *tree,void *elem,void **del_node );
+hyrbtree_ret_t hyrbtree_rekey_node( hyrbtree_t *tree,void *user_node,void *elem,
+    hyrbtree_update_t update,void **exist_node );
+
+/* In-order Iteration */
+void *hyrbtree_first( hyrbtree_t *tree );
+void *hyrbtree_last( hyrbtree_t *tree );
+void *hyrbtree_next( hyrbtree_t *tree,void *user_node );
+void *hyrbtree_prev( hyrbtree_t *tree,void *user_node );
+hyrbtree_ret_t hyrbtree_pop_first( hyrbtree_t *tree,void **pop_node );
+hyrbtree_ret_t hyrbtree_pop_last( hyrbtree_t *tree,void **pop_node );
+
+/* Ordered Search */
+hyrbtree_ret_t hyrbtree_lower_bound( hyrbtree_t *tree,void *elem,void **get_node );
+hyrbtree_ret_t hyrbtree_upper_bound( hyrbtree_t *tree,void *elem,void **get_node );
+hyrbtree_ret_t hyrbtree_floor( hyrbtree_t *tree,void *elem,void **get_node );
+hyrbtree_ret_t hyrbtree_ceiling( hyrbtree_t *tree,void *elem,void **get_node );
+hyrbtree_ret_t hyrbtree_range_scan( hyrbtree_t *tree,void *lo_elem,void *hi_elem,
+    hyrbtree_visit_t visit,void *arg );
+hyrbtree_ret_t hyrbtree_equal_range( hyrbtree_t *tree,void *elem,void **first_node,void **last_node );
+
+#if HYRBTREE_CFG_KEY_CACHE
+hy_u64_t hyrbtree_elem_cache_str( const void *str );
+#endif
+
+/* Order Statistics */
+hy_u32_t hyrbtree_count( hyrbtree_t *tree );
+#if HYRBTREE_CFG_SUBTREE_SIZE
+hyrbtree_ret_t hyrbtree_select( hyrbtree_t *tree,hy_u32_t rank,void **get_node );
+hyrbtree_ret_t hyrbtree_rank( hyrbtree_t *tree,void *elem,hy_u32_t *rank );
+hy_u32_t hyrbtree_node_rank( hyrbtree_t *tree,void *user_node );
+#endif
+
+/* Augmentation */
+void hyrbtree_augment_update( hyrbtree_t *tree,void *user_node );
+hyrbtree_ret_t hyrbtree_range_aggregate( hyrbtree_t *tree,void *lo_elem,void *hi_elem,
+    hyrbtree_collect_t collect,void *arg );
+
+/* Bulk Construction */
+hyrbtree_ret_t hyrbtree_build_sorted( hyrbtree_t *tree,void **user_nodes,hy_u32_t node_num );
+hyrbtree_ret_t hyrbtree_build_stream( hyrbtree_t *tree,hy_u32_t node_num,
+    void *(*next_node)(void *arg),void *arg );
+hyrbtree_ret_t hyrbtree_add_nodes( hyrbtree_t *tree,void **user_nodes,hy_u32_t node_num,
+    void **exist_nodes,hy_u8_t sort_nodes );
+
+/* Low-level link/unlink shared by the core API and specialized trees */
+void hyrbtree_link_node( hyrbtree_t *tree,hyrbnode_t *add_node,void *user_node,
+    hyrbnode_t *parent_node,hy_i32_t result );
+void hyrbtree_unlink_node( hyrbtree_t *tree,hyrbnode_t *node );
+
+
+
+/* Specialized trees compare keys inline, leave the generic key cache unregistered */
+#if HYRBTREE_CFG_KEY_CACHE
+#define HYRBTREE_SPEC_CLEAR_CACHE(tree) ((tree)->get_elem_cache = HY_NULL)
+#else
+#define HYRBTREE_SPEC_CLEAR_CACHE(tree) ((void)(tree))
+#endif
+
+/* Three-way comparison for scalar keys, usable as HYRBTREE_SPEC_DEFINE cmp */
+#define HYRBTREE_SPEC_CMP_SCALAR(a,b)   (((a)>(b))-((a)<(b)))
+
+/**
+ * @brief Generate a tree specialized for one user type at compile time
+ * @param name Prefix of the generated functions
+ * @param user_type Container structure type
+ * @param rbnode_member Name of the embedded hyrbnode_t member
+ * @param elem_member Name of the key member
+ * @param elem_type Type of the key member
+ * @param cmp Three-way comparison macro/function taking two elem_type values
+ * 
+ * Generates static inline functions operating on a plain hyrbtree_t:
+ * - name_init(tree): register offsets/comparator and initialize the tree
+ * - name_add_node(tree,user_node,exist_node)
+ * - name_get_node(tree,elem,get_node)
+ * - name_del_node(tree,user_node)
+ * 
+ * Key extraction and comparison are expanded inline, so the descent loops
+ * contain no indirect calls. Linking, unlinking and rebalancing stay in
+ * hyrbtree.c and are shared with the generic API, which also remains
+ * usable on a tree set up by name_init. The generated functions keep keys
+ * unique (multi_elem is ignored).
+ */
+#define HYRBTREE_SPEC_DEFINE(name,user_type,rbnode_member,elem_member,elem_type,cmp)    \
+static inline hy_i32_t name##_cmp_elem( void *elem1,void *elem2 ){                      \
+    return (hy_i32_t)(cmp(*(elem_type *)elem1,*(elem_type *)elem2));                    \
+}                                                                                       \
+static inline void name##_init( hyrbtree_t *tree ){                                     \
+    tree->get_rbnode = HY_NULL;                                                         \
+    tree->get_elem = HY_NULL;                                                           \
+    tree->rbnode_offset = offsetof(user_type,rbnode_member);                            \
+    tree->elem_offset = offsetof(user_type,elem_member);                                \
+    tree->cmp_elem = name##_cmp_elem;                                                   \
+    HYRBTREE_SPEC_CLEAR_CACHE(tree);                                                    \
+    hyrbtree_init( tree );                                                              \
+}                                                                                       \
+static inline hyrbtree_ret_t name##_add_node( hyrbtree_t *tree,user_type *user_node,    \
+    user_type **exist_node ){                                                           \
+    hyrbnode_t *cur_node;                                                               \
+    hyrbnode_t *parent_node;                                                            \
+    hy_i32_t result;                                                                    \
+                                                                                        \
+    if( HYRBTREE_GET_NODE_ADDR(&user_node->rbnode_member)!=HY_NULL ){                   \
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;                                     \
+    }                                                                                   \
+    parent_node = &tree->nil_node;                                                      \
+    result = 0;                                                                         \
+    cur_node = tree->root_node;                                                         \
+    while( cur_node!=&tree->nil_node ){                                                 \
+        parent_node = cur_node;                                                         \
+        result = (hy_i32_t)(cmp(user_node->elem_member,                                 \
+            HYRBTREE_CONTAINER_OF(cur_node,user_type,rbnode_member)->elem_member));     \
+        if( result<0 ){                                                                 \
+            cur_node = cur_node->left_node;                                             \
+        }                                                                               \
+        else if( result>0 ){                                                            \
+            cur_node = cur_node->right_node;                                            \
+        }                                                                               \
+        else{                                                                           \
+            *exist_node = HYRBTREE_CONTAINER_OF(cur_node,user_type,rbnode_member);      \
+            return HYRBTREE_RET_ADD_NODE_ELEM_EXIST;                                    \
+        }                                                                               \
+    }                                                                                   \
+    hyrbtree_link_node( tree,&user_node->rbnode_member,user_node,parent_node,result );  \
+    return HYRBTREE_RET_OK;                                                             \
+}                                                                                       \
+static inline hyrbtree_ret_t name##_get_node( hyrbtree_t *tree,elem_type elem,          \
+    user_type **get_node ){                                                             \
+    hyrbnode_t *cur_node;                                                               \
+    user_type *cur_user_node;                                                           \
+    hy_i32_t result;                                                                    \
+                                                                                        \
+    cur_node = tree->root_node;                                                         \
+    if( cur_node==&tree->nil_node ){                                                    \
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;                                         \
+    }                                                                                   \
+    do{                                                                                 \
+        cur_user_node = HYRBTREE_CONTAINER_OF(cur_node,user_type,rbnode_member);        \
+        result = (hy_i32_t)(cmp(elem,cur_user_node->elem_member));                      \
+        if( result==0 ){                                                                \
+            *get_node = cur_user_node;                                                  \
+            return HYRBTREE_RET_OK;                                                     \
+        }                                                                               \
+        cur_node = (result<0) ? cur_node->left_node : cur_node->right_node;             \
+    }while( cur_node!=&tree->nil_node );                                                \
+    return HYRBTREE_RET_GET_NODE_NOT_FIND;                                              \
+}                                                                                       \
+static inline hyrbtree_ret_t name##_del_node( hyrbtree_t *tree,user_type *user_node ){  \
+    if( HYRBTREE_GET_NODE_ADDR(&user_node->rbnode_member)==(void *)user_node ){         \
+        hyrbtree_unlink_node( tree,&user_node->rbnode_member );                         \
+        return HYRBTREE_RET_OK;                                                         \
+    }                                                                                   \
+    return HYRBTREE_RET_DEL_NODE_ARGS_ERROR;                                            \
+}
 
 #endif
@@ -0,0 +1,80 @@
+/**
+ * @file hyrbtree_fc.h
+ * @brief Flat-Combining Writer Front End
+ *
+ * Threads publish add/del/replace requests in per-thread slots; whichever
+ * thread wins the tree's writer lock applies every pending request in one
+ * write section, sorted by key and chained through insertion hints, then
+ * publishes the results. The tree stays in the combiner's cache and the
+ * lock changes hands once per batch instead of once per operation.
+ *
+ * Built on hyrbtree_sync_t, so lookups stay lock-free.
+ */
+
+#ifndef HYRBTREE_FC_H
+#define HYRBTREE_FC_H
+
+#include "hyrbtree_sync.h"
+
+
+
+/* Collection passes over the slots per combining round */
+#ifndef HYRBTREE_CFG_FC_PASSES
+#define HYRBTREE_CFG_FC_PASSES          2
+#endif
+
+/* Upper bound on slots per combiner (requests sorted per pass) */
+#ifndef HYRBTREE_CFG_FC_SLOTS
+#define HYRBTREE_CFG_FC_SLOTS           64
+#endif
+
+/* Request opcodes */
+enum{
+    HYRBTREE_FC_OP_ADD,
+    HYRBTREE_FC_OP_DEL,
+    HYRBTREE_FC_OP_REPLACE,
+};
+
+/* Slot states */
+enum{
+    HYRBTREE_FC_SLOT_IDLE,
+    HYRBTREE_FC_SLOT_PENDING,
+    HYRBTREE_FC_SLOT_DONE,
+};
+
+
+
+/**
+ * @brief Per-thread request slot (one cache line)
+ */
+typedef struct{
+    void *user_node;            ///< Node to add/delete, new node for replace
+    void *old_node;             ///< Replace: node being replaced
+    void *exist_node;           ///< Add: existing node on key collision
+    hyrbtree_ret_t ret;         ///< Result published by the combiner
+    hy_u8_t op;                 ///< HYRBTREE_FC_OP_*
+    hy_u8_t state;              ///< HYRBTREE_FC_SLOT_*
+}HY_ALIGNED(64) hyrbtree_fc_slot_t;
+
+/**
+ * @brief Flat-combining tree
+ *
+ * Fill sync.tree's callbacks/offsets, slots and slot_num, then call
+ * hyrbtree_fc_init. Each thread uses its own slot index.
+ */
+typedef struct{
+    hyrbtree_sync_t sync;       ///< Tree, writer lock and reader sequence
+    hyrbtree_fc_slot_t *slots;  ///< Caller storage, slot_num entries
+    hy_u32_t slot_num;          ///< Slots (<= HYRBTREE_CFG_FC_SLOTS)
+}hyrbtree_fc_t;
+
+
+
+/* Flat-Combining API */
+void hyrbtree_fc_init( hyrbtree_fc_t *fc );
+hyrbtree_ret_t hyrbtree_fc_add_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *user_node,void **exist_node );
+hyrbtree_ret_t hyrbtree_fc_del_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *user_node );
+hyrbtree_ret_t hyrbtree_fc_replace_node( hyrbtree_fc_t *fc,hy_u32_t slot,void *old_node,void *new_node );
+hyrbtree_ret_t hyrbtree_fc_get_node( hyrbtree_fc_t *fc,void *get_elem,void **get_node );
+
+#endif
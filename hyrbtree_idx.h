@@ -0,0 +1,90 @@
+/**
+ * @file hyrbtree_idx.h
+ * @brief Index-Addressed Red-Black Tree over a Node Array
+ *
+ * Variant for nodes that live in one caller-supplied array:
+ * - Links are 32-bit array indices, 12 bytes per node instead of 32
+ * - Color bit packed into the parent index
+ * - Position-independent: only node_base is an address, so the array may
+ *   be moved, copied or mapped at another address
+ *
+ * Same operations as the core tree (add/del/get, in-order iteration),
+ * addressed by array index instead of container pointer.
+ */
+
+#ifndef HYRBTREE_IDX_H
+#define HYRBTREE_IDX_H
+
+#include "hyrbtree.h"
+
+
+
+/* Null link (also the largest array size supported) */
+#define HYRBTREE_IDX_NIL                ((hy_u32_t)0x7FFFFFFF)
+
+/* left_idx of a node that is not linked in any tree */
+#define HYRBTREE_IDX_UNLINKED           ((hy_u32_t)0xFFFFFFFF)
+
+/* Color bit inside parent_idx (set = black) */
+#define HYRBTREE_IDX_COLOR_BIT          ((hy_u32_t)0x80000000)
+
+/* Macro to get the container at an array index */
+#define HYRBTREE_IDX_TO_USER(tree,idx)  ((void *)((hy_u8_t *)(tree)->node_base+(hy_uptr_t)(idx)*(tree)->node_stride))
+
+/**
+ * Initializer for a tree over an array of containers:
+ * hyrbtree_idx_t tree = { HYRBTREE_IDX_INIT(user_inode_t,pool,POOL_SIZE,inode,elem,cmp) };
+ */
+#define HYRBTREE_IDX_INIT(type,array,num,inode_member,elem_member,cmp)                  \
+    .node_base = (array),                                                               \
+    .node_num = (num),                                                                  \
+    .node_stride = sizeof(type),                                                        \
+    .rbnode_offset = offsetof(type,inode_member),                                       \
+    .elem_offset = offsetof(type,elem_member),                                          \
+    .cmp_elem = (cmp)
+
+
+
+/**
+ * @brief Index-linked node, embed in the array element
+ */
+typedef struct{
+    hy_u32_t parent_idx;        ///< Parent index, bit 31 holds the color
+    hy_u32_t left_idx;          ///< Left child, HYRBTREE_IDX_UNLINKED when detached
+    hy_u32_t right_idx;         ///< Right child
+}hyrbinode_t;
+
+/**
+ * @brief Index-addressed tree
+ */
+typedef struct{
+    void *node_base;            ///< Array of containers
+    hy_u32_t node_num;          ///< Array entries (< HYRBTREE_IDX_NIL)
+    hy_u32_t node_stride;       ///< Bytes per container
+    hy_u32_t rbnode_offset;     ///< hyrbinode_t offset inside the container
+    hy_u32_t elem_offset;       ///< Key offset inside the container
+
+    /**
+     * @brief Element comparison callback (see hyrbtree_t)
+     */
+    hy_i32_t (*cmp_elem)(void *elem1,void *elem2);
+
+    hy_u32_t node_count;        ///< Linked nodes
+    hy_u32_t root_idx;          ///< Root index, HYRBTREE_IDX_NIL when empty
+}hyrbtree_idx_t;
+
+
+
+/* Index Tree API */
+void hyrbtree_idx_init( hyrbtree_idx_t *tree );
+hyrbtree_ret_t hyrbtree_idx_add_node( hyrbtree_idx_t *tree,hy_u32_t idx,hy_u32_t *exist_idx );
+hyrbtree_ret_t hyrbtree_idx_del_node( hyrbtree_idx_t *tree,hy_u32_t idx );
+hyrbtree_ret_t hyrbtree_idx_get_node( hyrbtree_idx_t *tree,void *elem,hy_u32_t *get_idx );
+
+/* In-order Iteration (HYRBTREE_IDX_NIL past either end) */
+hy_u32_t hyrbtree_idx_first( hyrbtree_idx_t *tree );
+hy_u32_t hyrbtree_idx_last( hyrbtree_idx_t *tree );
+hy_u32_t hyrbtree_idx_next( hyrbtree_idx_t *tree,hy_u32_t idx );
+hy_u32_t hyrbtree_idx_prev( hyrbtree_idx_t *tree,hy_u32_t idx );
+
+#endif
@@ -0,0 +1,450 @@
+/**
+ * @file hyrbtree_shard.c
+ * @brief Sharded Red-Black Tree Container Implementation
+ *
+ * Lock order: route_lock, then shard write locks in ascending route
+ * position. Single-key operations take one shard lock and never
+ * route_lock; they validate their routing against route_seq after the
+ * shard lock is held, which a split only bumps while holding the
+ * source shard.
+ */
+
+#include "hyrbtree_shard.h"
+
+
+
+/**
+ * @brief Locate the key of a container
+ * @param tree Any shard tree (all share the template)
+ * @param user_node Container structure
+ * @return Pointer to comparable key
+ */
+static inline void *hyrbtree_shard_user_to_elem( hyrbtree_t *tree,void *user_node ){
+    if( tree->get_elem!=HY_NULL ){
+        return tree->get_elem(user_node);
+    }
+    return (void *)((hy_u8_t *)user_node+tree->elem_offset);
+}
+
+/**
+ * @brief Acquire the routing spinlock
+ * @param shard Sharded container
+ */
+static void hyrbtree_shard_route_lock( hyrbtree_shard_t *shard ){
+    while( __atomic_exchange_n(&shard->route_lock,1,__ATOMIC_ACQUIRE)!=0 ){
+        while( __atomic_load_n(&shard->route_lock,__ATOMIC_RELAXED)!=0 ){
+            HY_CPU_RELAX();
+        }
+    }
+}
+
+/**
+ * @brief Release the routing spinlock
+ * @param shard Sharded container
+ */
+static void hyrbtree_shard_route_unlock( hyrbtree_shard_t *shard ){
+    __atomic_store_n(&shard->route_lock,0,__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Begin reading the routing table
+ * @param shard Sharded container
+ * @return Routing sequence snapshot
+ */
+static hy_u32_t hyrbtree_shard_route_begin( hyrbtree_shard_t *shard ){
+    hy_u32_t seq;
+
+    while( ((seq=__atomic_load_n(&shard->route_seq,__ATOMIC_ACQUIRE)) & 0x1)!=0 ){
+        HY_CPU_RELAX();
+    }
+    return seq;
+}
+
+/**
+ * @brief Check whether a routing decision went stale
+ * @param shard Sharded container
+ * @param seq Value returned by hyrbtree_shard_route_begin
+ * @return Non-zero if a split ran meanwhile
+ */
+static hy_u8_t hyrbtree_shard_route_retry( hyrbtree_shard_t *shard,hy_u32_t seq ){
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&shard->route_seq,__ATOMIC_RELAXED)!=seq;
+}
+
+/**
+ * @brief Map a key to its route position
+ * @param shard Sharded container
+ * @param elem Key element
+ * @return Route position in [0,shard_num)
+ *
+ * Only reads inside the routing arrays, so a torn view during a split
+ * yields a wrong but in-range position that route_retry rejects.
+ */
+static hy_u32_t hyrbtree_shard_route( hyrbtree_shard_t *shard,void *elem ){
+    hy_u64_t key;
+    hy_u32_t shard_num;
+    hy_u32_t lo;
+    hy_u32_t hi;
+    hy_u32_t mid;
+
+    key = shard->route_key(elem);
+    shard_num = __atomic_load_n(&shard->shard_num,__ATOMIC_RELAXED);
+    if( shard->route_mode==HYRBTREE_SHARD_ROUTE_HASH ){
+        return (hy_u32_t)(key%shard_num);
+    }
+
+    lo = 0;
+    hi = shard_num-1;
+    while( lo<hi ){
+        mid = hi-(hi-lo)/2;
+        if( shard->route_bound[mid]<=key ){
+            lo = mid;
+        }
+        else{
+            hi = mid-1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Write-lock the shard owning a key
+ * @param shard Sharded container
+ * @param elem Key element
+ * @return Locked shard, routing verified under the lock
+ */
+static hyrbtree_sync_t *hyrbtree_shard_write_lock( hyrbtree_shard_t *shard,void *elem ){
+    hyrbtree_sync_t *sync;
+    hy_u32_t seq;
+
+    while(1){
+        seq = hyrbtree_shard_route_begin( shard );
+        sync = &shard->shards[ shard->route_slot[ hyrbtree_shard_route(shard,elem) ] ];
+        hyrbtree_sync_write_lock( sync );
+        if( hyrbtree_shard_route_retry( shard,seq )==0 ){
+            return sync;
+        }
+        hyrbtree_sync_write_unlock( sync );
+    }
+}
+
+
+
+/**
+ * @brief Initialize a sharded container
+ * @param shard Sharded container (storage and routing fields set)
+ * @param tree_template Tree whose callbacks/offsets every shard copies
+ */
+void hyrbtree_shard_init( hyrbtree_shard_t *shard,hyrbtree_t *tree_template ){
+    hy_u32_t i;
+
+    if( shard->shard_max>HYRBTREE_CFG_SHARD_MAX ){
+        shard->shard_max = HYRBTREE_CFG_SHARD_MAX;
+    }
+    if( shard->shard_num==0 ){
+        shard->shard_num = 1;
+    }
+    for( i=0;i<shard->shard_max;i++ ){
+        shard->shards[i].tree = *tree_template;
+        hyrbtree_sync_init( &shard->shards[i] );
+        shard->route_slot[i] = i;
+    }
+    shard->route_bound[0] = 0;
+    shard->route_seq = 0;
+    shard->route_lock = 0;
+}
+
+/**
+ * @brief Insert a node into its shard
+ * @param shard Sharded container
+ * @param user_node User data containing embedded rbnode
+ * @param exist_node [out] Returns existing node if key exists
+ * @return Operation status code (see hyrbtree_add_node)
+ */
+hyrbtree_ret_t hyrbtree_shard_add_node( hyrbtree_shard_t *shard,void *user_node,void **exist_node ){
+    hyrbtree_sync_t *sync;
+    hyrbtree_ret_t ret;
+
+    sync = hyrbtree_shard_write_lock( shard,hyrbtree_shard_user_to_elem(&shard->shards[0].tree,user_node) );
+    ret = hyrbtree_add_node( &sync->tree,user_node,exist_node );
+    hyrbtree_sync_write_unlock( sync );
+    return ret;
+}
+
+/**
+ * @brief Remove a node from its shard
+ * @param shard Sharded container
+ * @param user_node Node to delete
+ * @return Operation status code (see hyrbtree_del_node)
+ */
+hyrbtree_ret_t hyrbtree_shard_del_node( hyrbtree_shard_t *shard,void *user_node ){
+    hyrbtree_sync_t *sync;
+    hyrbtree_ret_t ret;
+
+    sync = hyrbtree_shard_write_lock( shard,hyrbtree_shard_user_to_elem(&shard->shards[0].tree,user_node) );
+    ret = hyrbtree_del_node( &sync->tree,user_node );
+    hyrbtree_sync_write_unlock( sync );
+    return ret;
+}
+
+/**
+ * @brief Find a node without taking locks
+ * @param shard Sharded container
+ * @param get_elem Key to search
+ * @param get_node [out] Found node
+ * @return Operation status code (see hyrbtree_get_node)
+ *
+ * Optimistic lookup in the owning shard (hyrbtree_sync_get_node),
+ * repeated if a split re-routed the key meanwhile.
+ */
+hyrbtree_ret_t hyrbtree_shard_get_node( hyrbtree_shard_t *shard,void *get_elem,void **get_node ){
+    hyrbtree_ret_t ret;
+    hy_u32_t seq;
+
+    do{
+        seq = hyrbtree_shard_route_begin( shard );
+        ret = hyrbtree_sync_get_node( &shard->shards[ shard->route_slot[ hyrbtree_shard_route(shard,get_elem) ] ],
+            get_elem,get_node );
+    }while( hyrbtree_shard_route_retry( shard,seq )!=0 );
+    return ret;
+}
+
+
+
+/* Forwarding state for per-shard scans */
+typedef struct{
+    hyrbtree_visit_t visit;
+    void *arg;
+    hy_u8_t stop;
+}hyrbtree_shard_scan_t;
+
+/**
+ * @brief Forward one node to the user visitor and remember a stop request
+ * @param user_node Visited container
+ * @param arg hyrbtree_shard_scan_t
+ * @return Visitor result
+ */
+static hy_u8_t hyrbtree_shard_scan_visit( void *user_node,void *arg ){
+    hyrbtree_shard_scan_t *scan = (hyrbtree_shard_scan_t *)arg;
+
+    scan->stop = scan->visit(user_node,scan->arg);
+    return scan->stop;
+}
+
+/**
+ * @brief Ordered scan over hash shards by k-way merge
+ * @param shard Sharded container (route_lock held)
+ * @param lo_elem Inclusive lower key, HY_NULL for unbounded
+ * @param hi_elem Inclusive upper key, HY_NULL for unbounded
+ * @param visit Visitor
+ * @param arg User argument
+ *
+ * Holds every shard's exclusive read lock for the duration of the scan.
+ */
+static void hyrbtree_shard_merge_scan( hyrbtree_shard_t *shard,void *lo_elem,void *hi_elem,
+    hyrbtree_visit_t visit,void *arg ){
+
+    hyrbtree_t *tree;
+    void *cursor[HYRBTREE_CFG_SHARD_MAX];
+    hy_u32_t i;
+    hy_u32_t min_i;
+
+    tree = &shard->shards[0].tree;
+    for( i=0;i<shard->shard_num;i++ ){
+        hyrbtree_sync_lock( &shard->shards[i] );
+        cursor[i] = HY_NULL;
+        if( lo_elem!=HY_NULL ){
+            hyrbtree_lower_bound( &shard->shards[i].tree,lo_elem,&cursor[i] );
+        }
+        else{
+            cursor[i] = hyrbtree_first( &shard->shards[i].tree );
+        }
+    }
+
+    while(1){
+        min_i = shard->shard_num;
+        for( i=0;i<shard->shard_num;i++ ){
+            if( cursor[i]!=HY_NULL && ( min_i==shard->shard_num ||
+                tree->cmp_elem( hyrbtree_shard_user_to_elem(tree,cursor[i]),
+                    hyrbtree_shard_user_to_elem(tree,cursor[min_i]) )<0 ) ){
+                min_i = i;
+            }
+        }
+        if( min_i==shard->shard_num ){
+            break;
+        }
+        if( hi_elem!=HY_NULL &&
+            tree->cmp_elem( hyrbtree_shard_user_to_elem(tree,cursor[min_i]),hi_elem )>0 ){
+            break;
+        }
+        if( visit(cursor[min_i],arg)!=0 ){
+            break;
+        }
+        cursor[min_i] = hyrbtree_next( &shard->shards[min_i].tree,cursor[min_i] );
+    }
+
+    for( i=0;i<shard->shard_num;i++ ){
+        hyrbtree_sync_unlock( &shard->shards[i] );
+    }
+}
+
+/**
+ * @brief Visit every node with lo_elem <= key <= hi_elem in key order
+ * @param shard Sharded container
+ * @param lo_elem Inclusive lower key, HY_NULL for unbounded
+ * @param hi_elem Inclusive upper key, HY_NULL for unbounded
+ * @param visit Called with each container in ascending key order
+ * @param arg User argument passed to visit
+ * @return HYRBTREE_RET_OK
+ *
+ * Range mode walks the covering shards in route order, locking one at a
+ * time; hash mode merges all shards. Splits wait for the scan. visit must
+ * not modify the container; returning non-zero stops the scan. A range
+ * with lo_elem after hi_elem visits nothing.
+ */
+hyrbtree_ret_t hyrbtree_shard_range_scan( hyrbtree_shard_t *shard,void *lo_elem,void *hi_elem,
+    hyrbtree_visit_t visit,void *arg ){
+
+    hyrbtree_shard_scan_t scan;
+    hyrbtree_sync_t *sync;
+    hy_u32_t position;
+    hy_u32_t end_position;
+
+    /* An inverted range is empty; every shard tree shares the template's cmp_elem */
+    if( lo_elem!=HY_NULL && hi_elem!=HY_NULL && shard->shards[0].tree.cmp_elem(lo_elem,hi_elem)>0 ){
+        return HYRBTREE_RET_OK;
+    }
+
+    hyrbtree_shard_route_lock( shard );
+    if( shard->route_mode==HYRBTREE_SHARD_ROUTE_HASH ){
+        hyrbtree_shard_merge_scan( shard,lo_elem,hi_elem,visit,arg );
+    }
+    else{
+        scan.visit = visit;
+        scan.arg = arg;
+        scan.stop = 0;
+        position = lo_elem!=HY_NULL ? hyrbtree_shard_route(shard,lo_elem) : 0;
+        end_position = hi_elem!=HY_NULL ? hyrbtree_shard_route(shard,hi_elem) : shard->shard_num-1;
+        for( ;position<=end_position && scan.stop==0;position++ ){
+            sync = &shard->shards[ shard->route_slot[position] ];
+            hyrbtree_sync_lock( sync );
+            hyrbtree_range_scan( &sync->tree,lo_elem,hi_elem,hyrbtree_shard_scan_visit,&scan );
+            hyrbtree_sync_unlock( sync );
+        }
+    }
+    hyrbtree_shard_route_unlock( shard );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Split a range shard at its median key
+ * @param shard Sharded container (range mode)
+ * @param position Route position of the shard to split
+ * @return Operation status code
+ *
+ * Moves the upper half of the shard into the next free shard and inserts
+ * it at position+1. Nodes sharing the median's route key stay together.
+ * Writers to other shards keep running; lookups and writes that race the
+ * move are re-routed.
+ * Returns:
+ * - HYRBTREE_RET_OK: Split done
+ * - HYRBTREE_RET_SHARD_SPLIT_ERROR: Hash mode, bad position, no free shard,
+ *   or fewer than two distinct route keys in the shard
+ */
+hyrbtree_ret_t hyrbtree_shard_split( hyrbtree_shard_t *shard,hy_u32_t position ){
+    hyrbtree_sync_t *src;
+    hyrbtree_sync_t *dst;
+    hyrbtree_t *tree;
+    void *cur_node;
+    void *prev_node;
+    void *next_node;
+    void *last_node;
+    void *exist_node;
+    hy_u64_t bound;
+    hy_u32_t i;
+
+    if( shard->route_mode!=HYRBTREE_SHARD_ROUTE_RANGE ){
+        return HYRBTREE_RET_SHARD_SPLIT_ERROR;
+    }
+    hyrbtree_shard_route_lock( shard );
+    if( position>=shard->shard_num || shard->shard_num>=shard->shard_max ){
+        hyrbtree_shard_route_unlock( shard );
+        return HYRBTREE_RET_SHARD_SPLIT_ERROR;
+    }
+
+    src = &shard->shards[ shard->route_slot[position] ];
+    dst = &shard->shards[ shard->shard_num ];
+    hyrbtree_sync_write_lock( src );
+    hyrbtree_sync_write_lock( dst );
+    tree = &src->tree;
+
+    cur_node = HY_NULL;
+    if( hyrbtree_count(tree)>=2 ){
+        cur_node = hyrbtree_first(tree);
+        for( i=0;i<hyrbtree_count(tree)/2;i++ ){
+            cur_node = hyrbtree_next(tree,cur_node);
+        }
+        bound = shard->route_key( hyrbtree_shard_user_to_elem(tree,cur_node) );
+        prev_node = hyrbtree_prev(tree,cur_node);
+        while( prev_node!=HY_NULL && shard->route_key( hyrbtree_shard_user_to_elem(tree,prev_node) )==bound ){
+            cur_node = prev_node;
+            prev_node = hyrbtree_prev(tree,cur_node);
+        }
+        if( prev_node==HY_NULL ){
+            while( cur_node!=HY_NULL && shard->route_key( hyrbtree_shard_user_to_elem(tree,cur_node) )==bound ){
+                cur_node = hyrbtree_next(tree,cur_node);
+            }
+            if( cur_node!=HY_NULL ){
+                bound = shard->route_key( hyrbtree_shard_user_to_elem(tree,cur_node) );
+            }
+        }
+    }
+    if( cur_node==HY_NULL ){
+        hyrbtree_sync_write_unlock( dst );
+        hyrbtree_sync_write_unlock( src );
+        hyrbtree_shard_route_unlock( shard );
+        return HYRBTREE_RET_SHARD_SPLIT_ERROR;
+    }
+
+    __atomic_store_n(&shard->route_seq,shard->route_seq+1,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    last_node = HY_NULL;
+    while( cur_node!=HY_NULL ){
+        next_node = hyrbtree_next(tree,cur_node);
+        hyrbtree_del_node( tree,cur_node );
+        hyrbtree_add_node_hint( &dst->tree,last_node,cur_node,&exist_node );
+        last_node = cur_node;
+        cur_node = next_node;
+    }
+
+    for( i=shard->shard_num;i>position+1;i-- ){
+        shard->route_slot[i] = shard->route_slot[i-1];
+        shard->route_bound[i] = shard->route_bound[i-1];
+    }
+    shard->route_slot[position+1] = shard->shard_num;
+    shard->route_bound[position+1] = bound;
+    shard->shard_num++;
+
+    __atomic_store_n(&shard->route_seq,shard->route_seq+1,__ATOMIC_RELEASE);
+    hyrbtree_sync_write_unlock( dst );
+    hyrbtree_sync_write_unlock( src );
+    hyrbtree_shard_route_unlock( shard );
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Get the number of linked nodes across all shards
+ * @param shard Sharded container
+ * @return Node count (a moving target while writers run)
+ */
+hy_u32_t hyrbtree_shard_count( hyrbtree_shard_t *shard ){
+    hy_u32_t count;
+    hy_u32_t i;
+
+    count = 0;
+    for( i=0;i<shard->shard_num;i++ ){
+        count += __atomic_load_n(&shard->shards[ shard->route_slot[i] ].tree.node_count,__ATOMIC_RELAXED);
+    }
+    return count;
+}
@@ -0,0 +1,438 @@
+/**
+ * @file hyrbtree_stream.c
+ * @brief Streaming Tree Checkpoint and Reload Implementation
+ *
+ * Stream layout (all integers little-endian u32):
+ * - Header: magic, version, flags, node_count, record_size
+ * - Blocks: raw_len, stored_len, stored_len bytes; stored_len==raw_len
+ *   means the block is stored uncompressed
+ *
+ * Records are laid end to end across block boundaries. Compressed blocks
+ * use an LZ77 token format: a token byte with the literal run length in
+ * the high nibble and match length minus 4 in the low nibble (15 = more
+ * length bytes follow, each 255 continues), the literals, then a 16-bit
+ * match offset. The last sequence of a block has literals only.
+ */
+
+#include <string.h>
+#include "hyrbtree_stream.h"
+
+
+
+/* Bytes in the stream header and in a block header */
+#define HYRBTREE_STREAM_HEADER_SIZE     20
+#define HYRBTREE_STREAM_BLOCK_HEADER    8
+
+/* Shortest match worth a token */
+#define HYRBTREE_STREAM_MIN_MATCH       4
+
+
+
+/**
+ * @brief Store a little-endian u32
+ * @param buf Destination
+ * @param value Value to store
+ */
+static inline void hyrbtree_stream_put_u32( hy_u8_t *buf,hy_u32_t value ){
+    buf[0] = (hy_u8_t)value;
+    buf[1] = (hy_u8_t)(value>>8);
+    buf[2] = (hy_u8_t)(value>>16);
+    buf[3] = (hy_u8_t)(value>>24);
+}
+
+/**
+ * @brief Load a little-endian u32
+ * @param buf Source
+ * @return Loaded value
+ */
+static inline hy_u32_t hyrbtree_stream_get_u32( const hy_u8_t *buf ){
+    return (hy_u32_t)buf[0] | (hy_u32_t)buf[1]<<8 | (hy_u32_t)buf[2]<<16 | (hy_u32_t)buf[3]<<24;
+}
+
+/**
+ * @brief Append an extended length (bytes of 255 then the remainder)
+ * @param dst Output buffer
+ * @param op Output position
+ * @param len Length beyond the nibble's 15
+ * @return New output position
+ */
+static inline hy_u32_t hyrbtree_stream_put_len( hy_u8_t *dst,hy_u32_t op,hy_u32_t len ){
+    while( len>=255 ){
+        dst[op++] = 255;
+        len -= 255;
+    }
+    dst[op++] = (hy_u8_t)len;
+    return op;
+}
+
+/**
+ * @brief Append one sequence to the packed block
+ * @param stream Stream context
+ * @param op Output position
+ * @param limit Largest allowed output size
+ * @param lit_pos Position of the literal run in raw_block
+ * @param lit_len Literal run length
+ * @param offset Match distance
+ * @param match_len Match length, 0 for the final literal-only sequence
+ * @return New output position, limit+1 if it would not fit
+ */
+static hy_u32_t hyrbtree_stream_put_seq( hyrbtree_stream_t *stream,hy_u32_t op,hy_u32_t limit,
+    hy_u32_t lit_pos,hy_u32_t lit_len,hy_u32_t offset,hy_u32_t match_len ){
+
+    hy_u8_t *dst;
+    hy_u32_t token_pos;
+    hy_u8_t token;
+
+    if( (hy_u64_t)op+1+lit_len+lit_len/255+1+(match_len!=0 ? 2+match_len/255+1 : 0)>limit ){
+        return limit+1;
+    }
+    dst = stream->pack_block;
+    token_pos = op++;
+    if( lit_len>=15 ){
+        token = 15<<4;
+        op = hyrbtree_stream_put_len( dst,op,lit_len-15 );
+    }
+    else{
+        token = (hy_u8_t)(lit_len<<4);
+    }
+    memcpy( dst+op,stream->raw_block+lit_pos,lit_len );
+    op += lit_len;
+
+    if( match_len!=0 ){
+        dst[op++] = (hy_u8_t)offset;
+        dst[op++] = (hy_u8_t)(offset>>8);
+        match_len -= HYRBTREE_STREAM_MIN_MATCH;
+        if( match_len>=15 ){
+            token |= 15;
+            op = hyrbtree_stream_put_len( dst,op,match_len-15 );
+        }
+        else{
+            token |= (hy_u8_t)match_len;
+        }
+    }
+    dst[token_pos] = token;
+    return op;
+}
+
+/**
+ * @brief Compress raw_block into pack_block
+ * @param stream Stream context
+ * @param raw_len Bytes in raw_block
+ * @return Packed size, 0 if it would not be smaller than raw_len
+ *
+ * Greedy single-probe hash match finder over 4-byte sequences.
+ */
+static hy_u32_t hyrbtree_stream_pack( hyrbtree_stream_t *stream,hy_u32_t raw_len ){
+    const hy_u8_t *src;
+    hy_u32_t limit;
+    hy_u32_t ip;
+    hy_u32_t op;
+    hy_u32_t anchor;
+    hy_u32_t ref;
+    hy_u32_t match_len;
+    hy_u32_t seq;
+    hy_u32_t hash;
+
+    if( raw_len<=HYRBTREE_STREAM_MIN_MATCH ){
+        return 0;
+    }
+    src = stream->raw_block;
+    limit = raw_len-1;
+    memset( stream->hash_table,0,sizeof(stream->hash_table) );
+
+    ip = 0;
+    op = 0;
+    anchor = 0;
+    while( ip+HYRBTREE_STREAM_MIN_MATCH<=raw_len ){
+        memcpy( &seq,src+ip,sizeof(seq) );
+        hash = (seq*2654435761u)>>(32-HYRBTREE_STREAM_HASH_BITS);
+        ref = stream->hash_table[hash];
+        stream->hash_table[hash] = (hy_u16_t)(ip+1);
+        if( ref==0 || memcmp( src+ref-1,src+ip,HYRBTREE_STREAM_MIN_MATCH )!=0 ){
+            ip++;
+            continue;
+        }
+
+        ref--;
+        match_len = HYRBTREE_STREAM_MIN_MATCH;
+        while( ip+match_len<raw_len && src[ref+match_len]==src[ip+match_len] ){
+            match_len++;
+        }
+        op = hyrbtree_stream_put_seq( stream,op,limit,anchor,ip-anchor,ip-ref,match_len );
+        if( op>limit ){
+            return 0;
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+    op = hyrbtree_stream_put_seq( stream,op,limit,anchor,raw_len-anchor,0,0 );
+    return op>limit ? 0 : op;
+}
+
+/**
+ * @brief Read an extended length
+ * @param src Packed block
+ * @param ip [in,out] Input position
+ * @param in_len Packed size
+ * @param len [in,out] Length to extend
+ * @return Non-zero on success
+ */
+static inline hy_u8_t hyrbtree_stream_get_len( const hy_u8_t *src,hy_u32_t *ip,hy_u32_t in_len,hy_u32_t *len ){
+    hy_u8_t byte;
+
+    do{
+        if( *ip>=in_len ){
+            return 0;
+        }
+        byte = src[ (*ip)++ ];
+        *len += byte;
+    }while( byte==255 );
+    return 1;
+}
+
+/**
+ * @brief Decompress pack_block into raw_block
+ * @param stream Stream context
+ * @param in_len Packed size
+ * @param raw_len Expected raw size
+ * @return Non-zero if the block decoded to exactly raw_len bytes
+ */
+static hy_u8_t hyrbtree_stream_unpack( hyrbtree_stream_t *stream,hy_u32_t in_len,hy_u32_t raw_len ){
+    const hy_u8_t *src;
+    hy_u8_t *dst;
+    hy_u32_t ip;
+    hy_u32_t op;
+    hy_u32_t lit_len;
+    hy_u32_t match_len;
+    hy_u32_t offset;
+    hy_u8_t token;
+
+    src = stream->pack_block;
+    dst = stream->raw_block;
+    ip = 0;
+    op = 0;
+    while( ip<in_len ){
+        token = src[ip++];
+        lit_len = token>>4;
+        if( lit_len==15 && hyrbtree_stream_get_len( src,&ip,in_len,&lit_len )==0 ){
+            return 0;
+        }
+        if( lit_len>in_len-ip || lit_len>raw_len-op ){
+            return 0;
+        }
+        memcpy( dst+op,src+ip,lit_len );
+        ip += lit_len;
+        op += lit_len;
+        if( ip==in_len ){
+            break;
+        }
+
+        if( in_len-ip<2 ){
+            return 0;
+        }
+        offset = (hy_u32_t)src[ip] | (hy_u32_t)src[ip+1]<<8;
+        ip += 2;
+        match_len = token&15;
+        if( match_len==15 && hyrbtree_stream_get_len( src,&ip,in_len,&match_len )==0 ){
+            return 0;
+        }
+        match_len += HYRBTREE_STREAM_MIN_MATCH;
+        if( offset==0 || offset>op || match_len>raw_len-op ){
+            return 0;
+        }
+        /* Byte copy: the match may overlap its own output */
+        for( ;match_len!=0;match_len--,op++ ){
+            dst[op] = dst[op-offset];
+        }
+    }
+    return op==raw_len;
+}
+
+/**
+ * @brief Write the buffered raw block
+ * @param stream Stream context
+ * @return Non-zero on success
+ */
+static hy_u8_t hyrbtree_stream_flush( hyrbtree_stream_t *stream ){
+    hy_u8_t block_header[HYRBTREE_STREAM_BLOCK_HEADER];
+    hy_u32_t stored_len;
+    hy_u8_t ok;
+
+    if( stream->block_len==0 ){
+        return 1;
+    }
+    stored_len = stream->compress!=0 ? hyrbtree_stream_pack( stream,stream->block_len ) : 0;
+    hyrbtree_stream_put_u32( block_header,stream->block_len );
+    hyrbtree_stream_put_u32( block_header+4,stored_len!=0 ? stored_len : stream->block_len );
+    ok = stream->write( stream->arg,block_header,HYRBTREE_STREAM_BLOCK_HEADER );
+    if( ok!=0 ){
+        if( stored_len!=0 ){
+            ok = stream->write( stream->arg,stream->pack_block,stored_len );
+        }
+        else{
+            ok = stream->write( stream->arg,stream->raw_block,stream->block_len );
+        }
+    }
+    stream->block_len = 0;
+    return ok;
+}
+
+/**
+ * @brief Read and decode the next block
+ * @param stream Stream context
+ * @return Operation status code
+ */
+static hyrbtree_ret_t hyrbtree_stream_fill( hyrbtree_stream_t *stream ){
+    hy_u8_t block_header[HYRBTREE_STREAM_BLOCK_HEADER];
+    hy_u32_t raw_len;
+    hy_u32_t stored_len;
+
+    if( stream->read( stream->arg,block_header,HYRBTREE_STREAM_BLOCK_HEADER )==0 ){
+        return HYRBTREE_RET_STREAM_IO_ERROR;
+    }
+    raw_len = hyrbtree_stream_get_u32( block_header );
+    stored_len = hyrbtree_stream_get_u32( block_header+4 );
+    if( raw_len==0 || raw_len>HYRBTREE_CFG_STREAM_BLOCK || stored_len==0 || stored_len>raw_len ){
+        return HYRBTREE_RET_STREAM_FORMAT_ERROR;
+    }
+
+    if( stored_len==raw_len ){
+        if( stream->read( stream->arg,stream->raw_block,raw_len )==0 ){
+            return HYRBTREE_RET_STREAM_IO_ERROR;
+        }
+    }
+    else{
+        if( stream->read( stream->arg,stream->pack_block,stored_len )==0 ){
+            return HYRBTREE_RET_STREAM_IO_ERROR;
+        }
+        if( hyrbtree_stream_unpack( stream,stored_len,raw_len )==0 ){
+            return HYRBTREE_RET_STREAM_FORMAT_ERROR;
+        }
+    }
+    stream->block_len = raw_len;
+    stream->block_pos = 0;
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Build source: decode the next record into a container
+ * @param arg Stream context
+ * @return Container, HY_NULL on error (stream->ret set for stream errors)
+ */
+static void *hyrbtree_stream_next_node( void *arg ){
+    hyrbtree_stream_t *stream;
+    hy_u32_t copy_len;
+    hy_u32_t record_pos;
+
+    stream = (hyrbtree_stream_t *)arg;
+    for( record_pos=0;record_pos<stream->record_size;record_pos+=copy_len ){
+        if( stream->block_pos==stream->block_len ){
+            stream->ret = hyrbtree_stream_fill( stream );
+            if( stream->ret!=HYRBTREE_RET_OK ){
+                return HY_NULL;
+            }
+        }
+        copy_len = stream->block_len-stream->block_pos;
+        if( copy_len>stream->record_size-record_pos ){
+            copy_len = stream->record_size-record_pos;
+        }
+        memcpy( stream->record+record_pos,stream->raw_block+stream->block_pos,copy_len );
+        stream->block_pos += copy_len;
+    }
+    return stream->decode_node( stream->record,stream->arg );
+}
+
+
+
+/**
+ * @brief Checkpoint a tree to a stream
+ * @param tree Tree structure
+ * @param stream Stream context (write, encode_node, record_size, compress set)
+ * @return Operation status code
+ *
+ * Visits the nodes in key order through the iterator, so memory use does
+ * not depend on the tree size.
+ * Returns:
+ * - HYRBTREE_RET_OK: Stream written
+ * - HYRBTREE_RET_STREAM_IO_ERROR: write failed
+ * - HYRBTREE_RET_STREAM_FORMAT_ERROR: record_size out of range
+ */
+hyrbtree_ret_t hyrbtree_stream_dump( hyrbtree_t *tree,hyrbtree_stream_t *stream ){
+    hy_u8_t header[HYRBTREE_STREAM_HEADER_SIZE];
+    void *user_node;
+    hy_u32_t copy_len;
+    hy_u32_t record_pos;
+
+    if( stream->record_size==0 || stream->record_size>HYRBTREE_CFG_STREAM_RECORD_MAX ){
+        return HYRBTREE_RET_STREAM_FORMAT_ERROR;
+    }
+    hyrbtree_stream_put_u32( header,HYRBTREE_STREAM_MAGIC );
+    hyrbtree_stream_put_u32( header+4,HYRBTREE_STREAM_VERSION );
+    hyrbtree_stream_put_u32( header+8,stream->compress!=0 ? HYRBTREE_STREAM_FLAG_COMPRESS : 0 );
+    hyrbtree_stream_put_u32( header+12,tree->node_count );
+    hyrbtree_stream_put_u32( header+16,stream->record_size );
+    if( stream->write( stream->arg,header,HYRBTREE_STREAM_HEADER_SIZE )==0 ){
+        return HYRBTREE_RET_STREAM_IO_ERROR;
+    }
+
+    stream->block_len = 0;
+    for( user_node=hyrbtree_first(tree);user_node!=HY_NULL;user_node=hyrbtree_next(tree,user_node) ){
+        stream->encode_node( user_node,stream->record,stream->arg );
+        for( record_pos=0;record_pos<stream->record_size;record_pos+=copy_len ){
+            copy_len = HYRBTREE_CFG_STREAM_BLOCK-stream->block_len;
+            if( copy_len>stream->record_size-record_pos ){
+                copy_len = stream->record_size-record_pos;
+            }
+            memcpy( stream->raw_block+stream->block_len,stream->record+record_pos,copy_len );
+            stream->block_len += copy_len;
+            if( stream->block_len==HYRBTREE_CFG_STREAM_BLOCK && hyrbtree_stream_flush( stream )==0 ){
+                return HYRBTREE_RET_STREAM_IO_ERROR;
+            }
+        }
+    }
+    if( hyrbtree_stream_flush( stream )==0 ){
+        return HYRBTREE_RET_STREAM_IO_ERROR;
+    }
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Reload a checkpoint into an empty tree
+ * @param tree Tree structure (initialized and empty)
+ * @param stream Stream context (read, decode_node, record_size set)
+ * @return Operation status code
+ *
+ * Containers are decoded one record at a time and linked in O(n) by
+ * hyrbtree_build_stream without calling cmp_elem. On failure the tree is
+ * left empty (see hyrbtree_build_stream).
+ * Returns:
+ * - HYRBTREE_RET_OK: Tree rebuilt
+ * - HYRBTREE_RET_BUILD_TREE_NOT_EMPTY: Tree already holds nodes
+ * - HYRBTREE_RET_BUILD_SOURCE_ERROR: decode_node returned HY_NULL
+ * - HYRBTREE_RET_STREAM_IO_ERROR: read failed or stream truncated
+ * - HYRBTREE_RET_STREAM_FORMAT_ERROR: Bad header, other record_size or
+ *   corrupt block
+ */
+hyrbtree_ret_t hyrbtree_stream_load( hyrbtree_t *tree,hyrbtree_stream_t *stream ){
+    hy_u8_t header[HYRBTREE_STREAM_HEADER_SIZE];
+    hyrbtree_ret_t ret;
+
+    if( stream->read( stream->arg,header,HYRBTREE_STREAM_HEADER_SIZE )==0 ){
+        return HYRBTREE_RET_STREAM_IO_ERROR;
+    }
+    if( hyrbtree_stream_get_u32(header)!=HYRBTREE_STREAM_MAGIC ||
+        hyrbtree_stream_get_u32(header+4)!=HYRBTREE_STREAM_VERSION ||
+        hyrbtree_stream_get_u32(header+16)!=stream->record_size ||
+        stream->record_size==0 || stream->record_size>HYRBTREE_CFG_STREAM_RECORD_MAX ){
+        return HYRBTREE_RET_STREAM_FORMAT_ERROR;
+    }
+
+    stream->ret = HYRBTREE_RET_OK;
+    stream->block_len = 0;
+    stream->block_pos = 0;
+    ret = hyrbtree_build_stream( tree,hyrbtree_stream_get_u32(header+12),hyrbtree_stream_next_node,stream );
+    if( ret==HYRBTREE_RET_BUILD_SOURCE_ERROR && stream->ret!=HYRBTREE_RET_OK ){
+        return stream->ret;
+    }
+    return ret;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file hyrbtree_stream.h
+ * @brief Streaming Tree Checkpoint and Reload
+ *
+ * Sequential checkpoint format for hyrbtree_t:
+ * - In-order dump of fixed-size records (key and payload reference,
+ *   produced by encode_node) through a write callback
+ * - Records packed into blocks, optionally LZ-compressed per block
+ * - Reload in O(n) through hyrbtree_build_stream, no cmp_elem calls
+ *
+ * Both directions run in bounded memory: one raw block and one packed
+ * block inside hyrbtree_stream_t, regardless of tree size.
+ */
+
+#ifndef HYRBTREE_STREAM_H
+#define HYRBTREE_STREAM_H
+
+#include "hyrbtree.h"
+
+
+
+/* Raw bytes per block (<= 65536, match offsets are 16-bit) */
+#ifndef HYRBTREE_CFG_STREAM_BLOCK
+#define HYRBTREE_CFG_STREAM_BLOCK       16384
+#endif
+
+/* Largest record_size accepted */
+#ifndef HYRBTREE_CFG_STREAM_RECORD_MAX
+#define HYRBTREE_CFG_STREAM_RECORD_MAX  256
+#endif
+
+/* Match finder hash table size (log2 entries) */
+#define HYRBTREE_STREAM_HASH_BITS       12
+
+/* Stream identification */
+#define HYRBTREE_STREAM_MAGIC           ((hy_u32_t)0x53525948)     /* "HYRS" */
+#define HYRBTREE_STREAM_VERSION         1
+
+/* Stream header flags */
+#define HYRBTREE_STREAM_FLAG_COMPRESS   0x1
+
+
+
+/**
+ * @brief Stream context
+ *
+ * Fill the callbacks, arg, record_size and compress, then pass to
+ * hyrbtree_stream_dump or hyrbtree_stream_load. The remaining fields are
+ * working storage.
+ */
+typedef struct{
+    /**
+     * @brief Write callback
+     * @param arg User argument
+     * @param data Bytes to write
+     * @param len Byte count
+     * @return Non-zero on success
+     */
+    hy_u8_t (*write)(void *arg,const void *data,hy_u32_t len);
+
+    /**
+     * @brief Read callback
+     * @param arg User argument
+     * @param data [out] Buffer to fill
+     * @param len Byte count, must be read completely
+     * @return Non-zero on success
+     */
+    hy_u8_t (*read)(void *arg,void *data,hy_u32_t len);
+
+    /**
+     * @brief Serialize one container
+     * @param user_node Container to dump
+     * @param record [out] record_size bytes
+     * @param arg User argument
+     */
+    void (*encode_node)(void *user_node,void *record,void *arg);
+
+    /**
+     * @brief Recreate one container
+     * @param record record_size bytes from the stream
+     * @param arg User argument
+     * @return Unlinked container with its key set, HY_NULL to abort
+     */
+    void* (*decode_node)(void *record,void *arg);
+
+    void *arg;                  ///< User argument for all callbacks
+    hy_u32_t record_size;       ///< Bytes per record (<= HYRBTREE_CFG_STREAM_RECORD_MAX)
+    hy_u8_t compress;           ///< Dump: non-zero to LZ-compress blocks
+
+    hyrbtree_ret_t ret;                                     ///< Error seen by the load source
+    hy_u32_t block_len;                                     ///< Valid bytes in raw_block
+    hy_u32_t block_pos;                                     ///< Load: next byte of raw_block
+    hy_u8_t record[HYRBTREE_CFG_STREAM_RECORD_MAX];         ///< Record being encoded/decoded
+    hy_u8_t raw_block[HYRBTREE_CFG_STREAM_BLOCK];           ///< Uncompressed block
+    hy_u8_t pack_block[HYRBTREE_CFG_STREAM_BLOCK];          ///< Compressed block
+    hy_u16_t hash_table[1<<HYRBTREE_STREAM_HASH_BITS];      ///< Match finder (position+1)
+}hyrbtree_stream_t;
+
+
+
+/* Stream API */
+hyrbtree_ret_t hyrbtree_stream_dump( hyrbtree_t *tree,hyrbtree_stream_t *stream );
+hyrbtree_ret_t hyrbtree_stream_load( hyrbtree_t *tree,hyrbtree_stream_t *stream );
+
+#endif
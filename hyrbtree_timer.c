@@ -0,0 +1,289 @@
+/**
+ * @file hyrbtree_timer.c
+ * @brief Deadline Timer Scheduler Implementation
+ */
+
+#include "hyrbtree_timer.h"
+
+
+
+/**
+ * @brief Deadline comparison
+ * @param elem1 First deadline (hy_u64_t)
+ * @param elem2 Second deadline (hy_u64_t)
+ * @return <0, 0 or >0
+ */
+static hy_i32_t hyrbtree_timer_cmp_elem( void *elem1,void *elem2 ){
+    hy_u64_t expire1;
+    hy_u64_t expire2;
+
+    expire1 = *(hy_u64_t *)elem1;
+    expire2 = *(hy_u64_t *)elem2;
+    return (expire1>expire2)-(expire1<expire2);
+}
+
+/**
+ * @brief Rekey callback: store the new deadline
+ * @param user_node Timer (hyrbtree_timer_node_t *)
+ * @param elem New deadline (hy_u64_t *)
+ */
+static void hyrbtree_timer_set_expire( void *user_node,void *elem ){
+    ((hyrbtree_timer_node_t *)user_node)->expire = *(hy_u64_t *)elem;
+}
+
+/**
+ * @brief Build source: pop the next survivor from its chain
+ * @param arg Chain head (hyrbtree_timer_node_t **)
+ * @return Next timer in deadline order
+ */
+static void *hyrbtree_timer_next_survivor( void *arg ){
+    hyrbtree_timer_node_t **survive_list;
+    hyrbtree_timer_node_t *timer_node;
+
+    survive_list = (hyrbtree_timer_node_t **)arg;
+    timer_node = *survive_list;
+    *survive_list = timer_node->next_node;
+    return timer_node;
+}
+
+/**
+ * @brief Detach all due timers by relinking the survivors
+ * @param timer Timer scheduler
+ * @param now Current time
+ * @param expire_list [out] Due timers in deadline order, chained by next_node
+ * @return Number of due timers
+ *
+ * One in-order sweep chains the due prefix and the surviving suffix, then
+ * the survivors are linked into a fresh balanced tree in O(n) with no
+ * comparisons and no per-node rebalancing.
+ */
+static hy_u32_t hyrbtree_timer_rebuild( hyrbtree_timer_t *timer,hy_u64_t now,
+    hyrbtree_timer_node_t **expire_list ){
+
+    hyrbtree_t *tree;
+    hyrbtree_timer_node_t *cur_node;
+    hyrbtree_timer_node_t *next_node;
+    hyrbtree_timer_node_t *expire_tail;
+    hyrbtree_timer_node_t *survive_list;
+    hy_u32_t expire_num;
+    hy_u32_t survive_num;
+
+    tree = &timer->tree;
+    expire_num = 0;
+    expire_tail = HY_NULL;
+    *expire_list = HY_NULL;
+    cur_node = (hyrbtree_timer_node_t *)hyrbtree_first(tree);
+    while( cur_node!=HY_NULL && cur_node->expire<=now ){
+        next_node = (hyrbtree_timer_node_t *)hyrbtree_next(tree,cur_node);
+        cur_node->rbnode.user_node = HY_NULL;
+        cur_node->next_node = HY_NULL;
+        if( expire_tail!=HY_NULL ){
+            expire_tail->next_node = cur_node;
+        }
+        else{
+            *expire_list = cur_node;
+        }
+        expire_tail = cur_node;
+        expire_num++;
+        cur_node = next_node;
+    }
+
+    survive_list = cur_node;
+    survive_num = 0;
+    while( cur_node!=HY_NULL ){
+        next_node = (hyrbtree_timer_node_t *)hyrbtree_next(tree,cur_node);
+        cur_node->next_node = next_node;
+        survive_num++;
+        cur_node = next_node;
+    }
+
+    hyrbtree_init( tree );
+    hyrbtree_build_stream( tree,survive_num,hyrbtree_timer_next_survivor,&survive_list );
+    return expire_num;
+}
+
+
+
+/**
+ * @brief Initialize a timer scheduler
+ * @param timer Timer scheduler
+ */
+void hyrbtree_timer_init( hyrbtree_timer_t *timer ){
+    hyrbtree_t *tree;
+
+    tree = &timer->tree;
+    tree->get_rbnode = HY_NULL;
+    tree->get_elem = HY_NULL;
+    tree->cmp_elem = hyrbtree_timer_cmp_elem;
+#if HYRBTREE_CFG_KEY_CACHE
+    tree->get_elem_cache = HY_NULL;
+#endif
+    tree->augment_node = HY_NULL;
+    tree->rbnode_offset = offsetof(hyrbtree_timer_node_t,rbnode);
+    tree->elem_offset = offsetof(hyrbtree_timer_node_t,expire);
+    tree->multi_elem = 1;
+    hyrbtree_init( tree );
+}
+
+/**
+ * @brief Arm a timer
+ * @param timer Timer scheduler
+ * @param timer_node Disarmed timer
+ * @param expire Deadline
+ * @return Operation status code
+ *
+ * A deadline not earlier than every armed one is linked beside the last
+ * node with a single inline comparison.
+ * Returns:
+ * - HYRBTREE_RET_OK: Armed
+ * - HYRBTREE_RET_ADD_NODE_UNINITIALIZED: Timer already armed
+ */
+hyrbtree_ret_t hyrbtree_timer_arm( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node,hy_u64_t expire ){
+    hyrbtree_t *tree;
+    hyrbnode_t *last_node;
+    void *exist_node;
+
+    if( hyrbtree_timer_armed(timer_node)!=0 ){
+        return HYRBTREE_RET_ADD_NODE_UNINITIALIZED;
+    }
+    timer_node->expire = expire;
+
+    tree = &timer->tree;
+    last_node = tree->last_node;
+    if( last_node!=&tree->nil_node &&
+        expire>=HYRBTREE_CONTAINER_OF(last_node,hyrbtree_timer_node_t,rbnode)->expire ){
+        hyrbtree_link_node( tree,&timer_node->rbnode,timer_node,last_node,1 );
+        return HYRBTREE_RET_OK;
+    }
+    return hyrbtree_add_node( tree,timer_node,&exist_node );
+}
+
+/**
+ * @brief Disarm a timer
+ * @param timer Timer scheduler
+ * @param timer_node Armed timer
+ * @return Operation status code
+ *
+ * Returns:
+ * - HYRBTREE_RET_OK: Disarmed
+ * - HYRBTREE_RET_DEL_NODE_ARGS_ERROR: Timer not armed
+ */
+hyrbtree_ret_t hyrbtree_timer_cancel( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node ){
+    return hyrbtree_del_node( &timer->tree,timer_node );
+}
+
+/**
+ * @brief Move a timer to a new deadline
+ * @param timer Timer scheduler
+ * @param timer_node Armed or disarmed timer
+ * @param expire New deadline
+ * @return Operation status code (see hyrbtree_timer_arm)
+ *
+ * An armed timer is rekeyed: while prev <= expire < next for its neighbors
+ * only the deadline is rewritten, so the timer still fires after timers
+ * sharing the new deadline; otherwise it is relinked from the nearest
+ * neighbor. A disarmed timer is armed.
+ */
+hyrbtree_ret_t hyrbtree_timer_rearm( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node,hy_u64_t expire ){
+    void *exist_node;
+
+    if( hyrbtree_timer_armed(timer_node)!=0 ){
+        return hyrbtree_rekey_node( &timer->tree,timer_node,&expire,hyrbtree_timer_set_expire,&exist_node );
+    }
+    return hyrbtree_timer_arm( timer,timer_node,expire );
+}
+
+/**
+ * @brief Check whether a timer is armed
+ * @param timer_node Timer
+ * @return Non-zero if armed
+ */
+hy_u8_t hyrbtree_timer_armed( hyrbtree_timer_node_t *timer_node ){
+    return HYRBTREE_GET_NODE_ADDR(&timer_node->rbnode)==(void *)timer_node;
+}
+
+/**
+ * @brief Get the earliest deadline
+ * @param timer Timer scheduler
+ * @param expire [out] Earliest armed deadline
+ * @return Operation status code
+ *
+ * O(1), for computing the event loop sleep.
+ * Returns:
+ * - HYRBTREE_RET_OK: expire set
+ * - HYRBTREE_RET_GET_NODE_TREE_NULL: No timer armed
+ */
+hyrbtree_ret_t hyrbtree_timer_next_expire( hyrbtree_timer_t *timer,hy_u64_t *expire ){
+    hyrbtree_timer_node_t *first_node;
+
+    first_node = (hyrbtree_timer_node_t *)hyrbtree_first(&timer->tree);
+    if( first_node==HY_NULL ){
+        return HYRBTREE_RET_GET_NODE_TREE_NULL;
+    }
+    *expire = first_node->expire;
+    return HYRBTREE_RET_OK;
+}
+
+/**
+ * @brief Expire every timer with a deadline not after now
+ * @param timer Timer scheduler
+ * @param now Current time
+ * @param expire_fn Callback run once per expired timer, in deadline order
+ * @param arg User argument passed to expire_fn
+ * @return Number of expired timers
+ *
+ * All due timers are detached before the first callback, so callbacks may
+ * arm, re-arm, cancel or free timers freely; a timer re-armed at or before
+ * now fires on the next call. Due timers are normally popped from the front
+ * one by one; when fewer than count>>HYRBTREE_CFG_TIMER_REBUILD_SHIFT timers
+ * would survive, the survivors are relinked in O(n) instead.
+ */
+hy_u32_t hyrbtree_timer_expire_until( hyrbtree_timer_t *timer,hy_u64_t now,
+    hyrbtree_timer_fn_t expire_fn,void *arg ){
+
+    hyrbtree_t *tree;
+    hyrbtree_timer_node_t *cur_node;
+    hyrbtree_timer_node_t *next_node;
+    hyrbtree_timer_node_t *expire_list;
+    hyrbtree_timer_node_t *expire_tail;
+    hy_u32_t expire_num;
+    hy_u32_t rebuild_num;
+    hy_u32_t i;
+
+    tree = &timer->tree;
+    rebuild_num = tree->node_count-(tree->node_count>>HYRBTREE_CFG_TIMER_REBUILD_SHIFT);
+
+    /* Count due timers, stopping as soon as a rebuild is the cheaper way */
+    expire_num = 0;
+    cur_node = (hyrbtree_timer_node_t *)hyrbtree_first(tree);
+    while( cur_node!=HY_NULL && cur_node->expire<=now && expire_num<=rebuild_num ){
+        expire_num++;
+        cur_node = (hyrbtree_timer_node_t *)hyrbtree_next(tree,cur_node);
+    }
+
+    if( expire_num<=rebuild_num ){
+        /* Few due: pop them off the front in deadline order */
+        expire_list = HY_NULL;
+        expire_tail = HY_NULL;
+        for( i=0;i<expire_num;i++ ){
+            hyrbtree_pop_first( tree,(void **)&cur_node );
+            cur_node->next_node = HY_NULL;
+            if( expire_tail!=HY_NULL ){
+                expire_tail->next_node = cur_node;
+            }
+            else{
+                expire_list = cur_node;
+            }
+            expire_tail = cur_node;
+        }
+    }
+    else{
+        expire_num = hyrbtree_timer_rebuild( timer,now,&expire_list );
+    }
+
+    for( cur_node=expire_list;cur_node!=HY_NULL;cur_node=next_node ){
+        next_node = cur_node->next_node;
+        expire_fn( cur_node,arg );
+    }
+    return expire_num;
+}
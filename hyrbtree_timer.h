@@ -0,0 +1,73 @@
+/**
+ * @file hyrbtree_timer.h
+ * @brief Deadline Timer Scheduler
+ *
+ * Timers ordered by a 64-bit deadline in a multimap hyrbtree_t:
+ * - Equal deadlines fire in arming order
+ * - Arming with later deadlines appends next to the last node in O(1)
+ * - Re-arming keeps the node in place while prev <= deadline < next for
+ *   its neighbors, so equal deadlines still fire in arming order
+ * - hyrbtree_timer_expire_until detaches every due timer before running
+ *   callbacks; when most timers are due the survivors are relinked in O(n)
+ *   instead of rebalancing once per expired timer
+ *
+ * The deadline unit (ticks, ns, ...) is up to the caller.
+ */
+
+#ifndef HYRBTREE_TIMER_H
+#define HYRBTREE_TIMER_H
+
+#include "hyrbtree.h"
+
+
+
+/* Relink the survivors when fewer than count>>SHIFT timers outlive an expiry */
+#ifndef HYRBTREE_CFG_TIMER_REBUILD_SHIFT
+#define HYRBTREE_CFG_TIMER_REBUILD_SHIFT    2
+#endif
+
+
+
+/**
+ * @brief Timer node
+ *
+ * Embed in the user structure and recover it with HYRBTREE_CONTAINER_OF.
+ * Zero it (rbnode.user_node HY_NULL) before the first arm.
+ */
+typedef struct hyrbtree_timer_node_t{
+    hy_u64_t expire;                            ///< Deadline, read-only while armed
+    hyrbnode_t rbnode;                          ///< Tree link
+    struct hyrbtree_timer_node_t *next_node;    ///< Chain used by hyrbtree_timer_expire_until
+}hyrbtree_timer_node_t;
+
+/**
+ * @brief Timer scheduler
+ */
+typedef struct{
+    hyrbtree_t tree;            ///< Armed timers by deadline (set up by hyrbtree_timer_init)
+}hyrbtree_timer_t;
+
+/**
+ * @brief Callback for expired timers
+ * @param timer_node Expired timer, already disarmed (may be re-armed or freed)
+ * @param arg User argument
+ */
+typedef void (*hyrbtree_timer_fn_t)( hyrbtree_timer_node_t *timer_node,void *arg );
+
+
+
+/* Setup */
+void hyrbtree_timer_init( hyrbtree_timer_t *timer );
+
+/* Timer Operations */
+hyrbtree_ret_t hyrbtree_timer_arm( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node,hy_u64_t expire );
+hyrbtree_ret_t hyrbtree_timer_cancel( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node );
+hyrbtree_ret_t hyrbtree_timer_rearm( hyrbtree_timer_t *timer,hyrbtree_timer_node_t *timer_node,hy_u64_t expire );
+hy_u8_t hyrbtree_timer_armed( hyrbtree_timer_node_t *timer_node );
+
+/* Expiry */
+hyrbtree_ret_t hyrbtree_timer_next_expire( hyrbtree_timer_t *timer,hy_u64_t *expire );
+hy_u32_t hyrbtree_timer_expire_until( hyrbtree_timer_t *timer,hy_u64_t now,
+    hyrbtree_timer_fn_t expire_fn,void *arg );
+
+#endif